@@ -0,0 +1,8 @@
+{
+	"camera": "../config/camera.js",
+	"params": "../config/params.js",
+	"scene": "../config/scene.js",
+	"features": "../obs/linked-observations-R12-A.bin.gz",
+	"invdistortion": "false",
+	"blur": "false"
+}
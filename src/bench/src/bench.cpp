@@ -0,0 +1,379 @@
+//STD
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <ctime>
+//BOOST
+#include <boost/filesystem.hpp>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/graphic/gui.h>
+#include <pleno/io/printer.h>
+
+//geometry
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+//calibration
+#include <pleno/processing/calibration/calibration.h>
+
+//config
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/scene.h>
+#include <pleno/io/cfg/observations.h>
+#include <pleno/io/cfg/poses.h>
+
+//COMPOTE
+#include <compote/codec.h>
+#include <compote/pipeline.h>
+#include <compote/anytime.h>
+#include <compote/snapshot.h>
+
+#include "utils.h"
+
+namespace fs = boost::filesystem;
+
+//Time a benchmark over several repetitions and keep statistics, results are saved as json 
+//with stable names so that runs from different commits can be compared.
+class Benchmarks {
+	struct Result {
+		std::string name;
+		std::size_t items;
+		std::vector<double> times; //ms
+		std::vector<std::pair<std::string, double>> metrics; //e.g., compression ratio
+	};
+	
+	const Config_t& config;
+	std::vector<Result> results;
+	
+public:
+	explicit Benchmarks(const Config_t& cfg) : config{cfg} {}
+	
+	bool selected(const std::string& name) const 
+	{
+		return config.filter == "" or name.find(config.filter) != std::string::npos;
+	}
+	
+	template<typename Setup, typename Run>
+	void run(const std::string& name, std::size_t items, Setup&& setup, Run&& bench)
+	{
+		if (not selected(name)) return;
+		
+		Result r{name, items, {}}; r.times.reserve(config.repeat);
+		for (std::size_t i = 0; i < config.repeat; ++i)
+		{
+			setup();
+			const auto start = std::chrono::steady_clock::now();
+			bench();
+			r.times.emplace_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		
+		std::sort(r.times.begin(), r.times.end());
+		PRINT_WARN("=== " << name << ": median = " << r.times[r.times.size() / 2] << " ms (" << items << " items)");
+		std::cout << std::flush;
+		
+		results.emplace_back(std::move(r));
+	}
+	
+	template<typename Run>
+	void run(const std::string& name, std::size_t items, Run&& bench)
+	{
+		run(name, items, [](){}, std::forward<Run>(bench));
+	}
+	
+	//Attach a value to the last benchmark run, if it was selected
+	void metric(const std::string& name, const std::string& key, double value)
+	{
+		if (not selected(name) or results.empty() or results.back().name != name) return;
+		
+		PRINT_WARN("\t" << key << " = " << value);
+		results.back().metrics.emplace_back(key, value);
+	}
+	
+	void save(const std::string& path) const
+	{
+		std::ofstream ofs(path);
+		ofs.precision(9);
+		
+		ofs << "{\n\t\"meta\": {\"compiler\": \"" << __VERSION__ << "\", \"date\": " << std::time(nullptr)
+			<< ", \"repeat\": " << config.repeat << ", \"frames\": " << config.frames << "},\n";
+		ofs << "\t\"benchmarks\": [\n";
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			const auto& r = results[i];
+			const double mean = std::accumulate(r.times.begin(), r.times.end(), 0.) / r.times.size();
+			const double median = r.times[r.times.size() / 2];
+			
+			ofs << "\t\t{\"name\": \"" << r.name << "\", \"items\": " << r.items
+				<< ", \"min_ms\": " << r.times.front() << ", \"median_ms\": " << median 
+				<< ", \"mean_ms\": " << mean << ", \"max_ms\": " << r.times.back()
+				<< ", \"items_per_s\": " << (median > 0. ? 1e3 * r.items / median : 0.);
+			for (const auto& [key, value] : r.metrics) ofs << ", \"" << key << "\": " << value;
+			ofs << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		ofs << "\t]\n}\n";
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	Config_t config = parse_args(argc, argv);
+	
+	Viewer::enable(false);
+	
+	Printer::verbose(config.verbose);
+	Printer::level(config.level | Printer::Level::WARN);
+	
+	PRINT_WARN("========= COMPOTE benchmarks on R12-A =========");
+	const fs::path data{config.path.data};
+
+////////////////////////////////////////////////////////////////////////////////
+// 1) Load R12-A data
+////////////////////////////////////////////////////////////////////////////////
+	const std::string obspath = (data / "obs" / "linked-observations-R12-A.bin.gz").string();
+	
+	ObservationsConfig cfg_obs;
+	v::load(obspath, cfg_obs);
+	const BAPObservations bap_obs = cfg_obs.features();
+	const MICObservations center_obs = cfg_obs.centers();
+	
+	PlenopticCamera mfpc;
+	load((data / "config" / "intrinsics.js").string(), mfpc);
+	{
+		InternalParameters params;
+		v::load((data / "config" / "params.js").string(), v::make_serializable(&params));
+		mfpc.params() = params;
+	}
+	
+	PlenopticCameraConfig cfg_camera;
+	v::load((data / "config" / "camera.js").string(), cfg_camera);
+	
+	SceneConfig cfg_scene;
+	v::load((data / "config" / "scene.js").string(), cfg_scene);
+	CheckerBoard scene{cfg_scene.checkerboards()[0]};
+	
+	CalibrationPosesConfig cfg_poses;
+	v::load((data / "config" / "poses.js").string(), cfg_poses);
+	
+	std::map<int, Pose> poses;
+	for (const auto& cfg_pose : cfg_poses.poses()) poses[cfg_pose.frame()] = cfg_pose.pose();
+	
+	//subset of frames used by the optimizations
+	std::set<int> frames;
+	for (const auto& [f, _] : poses) if (frames.size() < config.frames) frames.insert(f);
+	
+	BAPObservations subset;
+	std::copy_if(
+		bap_obs.begin(), bap_obs.end(), std::back_inserter(subset),
+		[&frames](const auto& o) { return frames.count(o.frame) > 0; }
+	);
+	
+	PRINT_WARN("Loaded " << bap_obs.size() << " BAP observations, " << center_obs.size() << " centers, " 
+		<< poses.size() << " poses (" << subset.size() << " observations in " << frames.size() << " frames)");
+
+	Benchmarks benchmarks{config};
+
+////////////////////////////////////////////////////////////////////////////////
+// 2) Observations I/O
+////////////////////////////////////////////////////////////////////////////////
+	benchmarks.run("observations/load", bap_obs.size() + center_obs.size(), [&obspath]() {
+		ObservationsConfig cfg;
+		v::load(obspath, cfg);
+	});
+	
+	const std::string tmppath = (fs::temp_directory_path() / fs::unique_path("compote-bench-%%%%%%.bin.gz")).string();
+	benchmarks.run("observations/save", bap_obs.size() + center_obs.size(), [&tmppath, &cfg_obs]() {
+		v::save(tmppath, cfg_obs);
+	});
+	fs::remove(tmppath);
+	
+	//codecs, on the serialized observations: items are bytes, so that items_per_s is the throughput
+	{
+		const std::string binpath = (fs::temp_directory_path() / fs::unique_path("compote-bench-%%%%%%.bin")).string();
+		v::save(binpath, cfg_obs);
+		
+		std::string raw;
+		{
+			std::ifstream ifs(binpath, std::ios::binary);
+			raw.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+		}
+		fs::remove(binpath);
+		
+		using compote::codec::Codec;
+		for (const Codec codec : {Codec::None, Codec::Gzip, Codec::Zstd, Codec::LZ4})
+		{
+			if (not compote::codec::available(codec)) continue;
+			const std::string name = compote::codec::name(codec);
+			
+			if (codec != Codec::None)
+			{
+				std::string compressed;
+				benchmarks.run("codec/" + name + "/compress", raw.size(), [&]() {
+					compressed = compote::codec::compress(raw, codec);
+				});
+				benchmarks.metric("codec/" + name + "/compress", "ratio", compressed.empty() ? 0. : double(raw.size()) / compressed.size());
+				
+				if (compressed.empty()) compressed = compote::codec::compress(raw, codec);
+				benchmarks.run("codec/" + name + "/decompress", raw.size(), [&]() {
+					const std::string decompressed = compote::codec::decompress(compressed);
+					if (decompressed.size() != raw.size()) PRINT_ERR("codec " << name << ": size mismatch");
+				});
+			}
+			
+			//end-to-end, on disk: serialization, temporary file and (de)compression
+			const std::string path = compote::codec::path((fs::temp_directory_path() / fs::unique_path("compote-bench-%%%%%%.bin")).string(), codec);
+			benchmarks.run("observations/save/" + name, bap_obs.size() + center_obs.size(), [&path, &cfg_obs]() {
+				compote::codec::save(path, cfg_obs);
+			});
+			if (not fs::exists(path)) compote::codec::save(path, cfg_obs);
+			benchmarks.metric("observations/save/" + name, "bytes", double(fs::file_size(path)));
+			
+			benchmarks.run("observations/load/" + name, bap_obs.size() + center_obs.size(), [&path]() {
+				ObservationsConfig cfg;
+				compote::codec::load(path, cfg);
+			});
+			fs::remove(path);
+		}
+	}
+
+	//calibration (camera, internal parameters, poses) from its json configuration files vs a snapshot
+	{
+		const std::string intrinsics = (data / "config" / "intrinsics.js").string();
+		const std::string params = (data / "config" / "params.js").string();
+		const std::string extrinsics = (data / "config" / "poses.js").string();
+		
+		benchmarks.run("calibration-files/load/json", 1, [&]() {
+			PlenopticCamera camera;
+			load(intrinsics, camera);
+			v::load(params, v::make_serializable(&camera.params()));
+			CalibrationPosesConfig cfg;
+			v::load(extrinsics, cfg);
+		});
+		benchmarks.metric("calibration-files/load/json", "bytes", double(fs::file_size(intrinsics) + fs::file_size(params) + fs::file_size(extrinsics)));
+		
+		const std::string snappath = (fs::temp_directory_path() / fs::unique_path("compote-bench-%%%%%%.snap")).string();
+		compote::snapshot::save(snappath, compote::snapshot::from_json(intrinsics, params, "", extrinsics));
+		
+		benchmarks.run("calibration-files/load/snapshot", 1, [&snappath]() {
+			const compote::snapshot::Snapshot snapshot = compote::snapshot::load(snappath);
+			PlenopticCamera camera = compote::snapshot::camera(*snapshot.camera);
+			camera.params() = *snapshot.params;
+		});
+		benchmarks.metric("calibration-files/load/snapshot", "bytes", double(fs::file_size(snappath)));
+		fs::remove(snappath);
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// 3) Projection and residuals
+////////////////////////////////////////////////////////////////////////////////
+	//corners in camera frame, for each observation
+	std::vector<P3D> corners; corners.reserve(bap_obs.size());
+	std::vector<std::size_t> indexes; indexes.reserve(bap_obs.size());
+	for (std::size_t i = 0; i < bap_obs.size(); ++i)
+	{
+		const auto it = poses.find(bap_obs[i].frame);
+		if (it == poses.end()) continue;
+		
+		scene.pose() = it->second;
+		corners.emplace_back(to_coordinate_system_of(mfpc.pose(), scene.nodeInWorld(bap_obs[i].cluster)));
+		indexes.emplace_back(i);
+	}
+	
+	double sink = 0.;
+	benchmarks.run("projection/corners", corners.size(), [&]() {
+		for (std::size_t i = 0; i < corners.size(); ++i)
+		{
+			const auto& o = bap_obs[indexes[i]];
+			P2D pixel;
+			if (mfpc.project(corners[i], o.k, o.l, pixel)) sink += pixel[0];
+		}
+	});
+	
+	benchmarks.run("residuals/bap", corners.size(), [&]() {
+		double cost = 0.;
+		for (std::size_t i = 0; i < corners.size(); ++i)
+		{
+			const auto& o = bap_obs[indexes[i]];
+			P3D bap;
+			if (mfpc.project(corners[i], o.k, o.l, bap))
+			{
+				cost += (bap - P3D{o.u, o.v, o.rho}).squaredNorm();
+			}
+		}
+		sink += cost;
+	});
+	PRINT_DEBUG("sink = " << sink);
+
+////////////////////////////////////////////////////////////////////////////////
+// 4) Optimizations
+////////////////////////////////////////////////////////////////////////////////
+	//starting from the calibrated camera, LM converges in a few iterations: this measures the 
+	//fixed cost of setting up and evaluating one optimization over the selected frames
+	PlenopticCamera model;
+	benchmarks.run("calibration/PlenopticCamera", subset.size(), 
+		[&model, &mfpc]() { model = mfpc; },
+		[&model, &scene, &subset, &center_obs]() {
+			CalibrationPoses cposes;
+			calibration_PlenopticCamera(cposes, model, scene, subset, center_obs, IndexedImages{});
+		}
+	);
+	
+	//from the initial model: a single solve on every observation vs the coarse-to-fine stages, the final
+	//rmse being recorded to check that both reach the same solution
+	const PlenopticCamera initial = compote::initial_camera(cfg_camera, mfpc.mia(), mfpc.params());
+	for (const auto& stages : {std::make_pair(std::string("single-stage"), compote::Schedule{}), std::make_pair(std::string("schedule"), compote::Schedule::anytime())})
+	{
+		const std::string& name = stages.first;
+		const compote::Schedule& schedule = stages.second;
+		
+		double rmse = 0.;
+		benchmarks.run("calibration/" + name, subset.size(), 
+			[&model, &initial]() { model = initial; },
+			[&]() {
+				CalibrationPoses cposes;
+				rmse = compote::calibrate_anytime(cposes, model, scene, subset, center_obs, IndexedImages{}, schedule, compote::Budget{}).cost;
+			}
+		);
+		benchmarks.metric("calibration/" + name, "rmse", rmse);
+	}
+	
+	benchmarks.run("calibration/Extrinsics", subset.size(), [&mfpc, &scene, &subset]() {
+		CalibrationPoses cposes;
+		calibration_ExtrinsicsPlenopticCamera(cposes, mfpc, scene, subset, IndexedImages{});
+	});
+	
+	CheckerBoards boards; boards.reserve(poses.size());
+	for (const auto& [_, p] : poses)
+	{
+		scene.pose() = p;
+		boards.emplace_back(scene);
+	}
+	benchmarks.run("calibration/inverseDistortions", boards.size(), [&mfpc, &boards]() {
+		Distortions invdistortions;
+		calibration_inverseDistortions(invdistortions, mfpc, boards);
+	});
+	
+	if (center_obs.size() > 0u)
+	{
+		MIA mia;
+		benchmarks.run("calibration/MIA", center_obs.size(),
+			[&mia, &cfg_camera]() { mia = MIA{cfg_camera.mia()}; },
+			[&mia, &center_obs]() { calibration_MIA(mia, center_obs); }
+		);
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// 5) Save results
+////////////////////////////////////////////////////////////////////////////////
+	benchmarks.save(config.path.output);
+	PRINT_WARN("Results saved in " << config.path.output);
+	
+	return 0;
+}
@@ -0,0 +1,80 @@
+#include "utils.h"
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(false),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ERR),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("data,d",
+			po::value<std::string>()->default_value("../examples"),
+			"Path to the examples directory (config/ and obs/ of R12-A)"
+		)
+		("repeat,r",
+			po::value<std::size_t>()->default_value(5),
+			"Number of repetitions of each benchmark"
+		)
+		("frames,n",
+			po::value<std::size_t>()->default_value(2),
+			"Number of frames used by the optimization benchmarks"
+		)
+		("filter",
+			po::value<std::string>()->default_value(""),
+			"Only run benchmarks whose name contains this string"
+		)
+		("output,o",
+			po::value<std::string>()->default_value("bench.json"),
+			"Path to save benchmark results (json)"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "COMPOTE benchmarks:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	if (vm.count("help"))
+	{
+		/* print usage */
+		std::cout << "COMPOTE benchmarks:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	Config_t config;
+	
+	config.verbose			= vm["verbose"].as<bool>();
+	config.level			= vm["level"].as<std::uint16_t>();
+	config.repeat			= std::max<std::size_t>(1, vm["repeat"].as<std::size_t>());
+	config.frames			= std::max<std::size_t>(1, vm["frames"].as<std::size_t>());
+	config.filter			= vm["filter"].as<std::string>();
+	config.path.data 		= vm["data"].as<std::string>();
+	config.path.output 		= vm["output"].as<std::string>();
+	
+	return config; 
+}
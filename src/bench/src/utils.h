@@ -0,0 +1,20 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	std::size_t repeat;
+	std::size_t frames;
+	std::string filter;
+	
+	struct {
+		std::string data;
+		std::string output;
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);
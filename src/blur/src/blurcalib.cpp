@@ -31,6 +31,10 @@
 
 #include <pleno/io/images.h>
 
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/csv.h>
+
 #include "utils.h"
 
 int main(int argc, char* argv[])
@@ -42,6 +46,8 @@ int main(int argc, char* argv[])
 	
 	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
 	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
 
 ////////////////////////////////////////////////////////////////////////////////
 // 1) Load Images from configuration file
@@ -50,6 +56,7 @@ int main(int argc, char* argv[])
 	Image mask;
 	std::size_t imgformat = 8;
 	{
+		TRACE_STEP("1) Load images");
 		PRINT_WARN("1) Load Images from configuration file");
 		ImagesConfig cfg_images;
 		v::load(config.path.images, cfg_images);		
@@ -80,6 +87,7 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 2) Load internal parameters from configuration file
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("2) Load internal parameters");
 	PRINT_WARN("2) Load internal parameters from configuration file");
 	InternalParameters params;
 	v::load(config.path.params, v::make_serializable(&params));
@@ -89,11 +97,12 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 3) Features extraction step
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("3) Load features");
 	PRINT_WARN("3) Load Features");	
 	BAPObservations bap_obs;
 	{
 		ObservationsConfig cfg_obs;
-		v::load(config.path.features, cfg_obs);
+		compote::csv::load(config.path.features, cfg_obs);
 
 		bap_obs = cfg_obs.features(); DEBUG_VAR(bap_obs.size());
 		
@@ -106,11 +115,15 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 4) Starting Calibration of the Relative blur Radius
 ////////////////////////////////////////////////////////////////////////////////	
+	compote::trace::step_arg("bap observations", bap_obs.size());
+	
+	TRACE_STEP("4) Blur calibration");
 	PRINT_WARN("4) Starting Calibration of the Relative blur Radius");
 	PRINT_WARN("\t4.1) Devignetting images");
 			
 	IndexedImages pictures;
 	
+	compote::trace::Scope devignetting_scope{"4.1) Devignetting images"};
 	std::transform(
 		checkerboards.begin(), checkerboards.end(),
 		std::inserter(pictures, pictures.end()),
@@ -126,15 +139,24 @@ int main(int argc, char* argv[])
 		}	
 	);	
 
+	devignetting_scope.close();
+	
 	PRINT_WARN("\t4.2) Calibrate");	
-	calibration_relativeBlur(params, bap_obs, pictures);
+	{
+		compote::trace::Scope scope{"4.2) calibration_relativeBlur"};
+		scope.arg("bap observations", bap_obs.size());
+		scope.arg("images", pictures.size());
+		calibration_relativeBlur(params, bap_obs, pictures);
+	}
 	
 	if(save())
 	{
+		TRACE_STEP("5) Save");
 		PRINT_WARN("5) Saving internals parameters");
 		v::save("params-"+std::to_string(getpid())+".js", v::make_serializable(&params));
 	}
 	
+	compote::trace::flush();
 	PRINT_INFO("========= EOF =========");
 
 	Viewer::wait();
@@ -38,11 +38,15 @@ Config_t parse_args(int argc, char *argv[])
 		)
 		("features,f",
 			po::value<std::string>()->default_value(""),
-			"Path to observations file"
+			"Path to observations file, or comma-separated list of files (.csv features and/or centers)"
 		)
 		("output,o",
 			po::value<std::string>()->default_value("kaka.js"),
 			"Path to save intrinsics parameters file"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
 		);
 
 	po::variables_map vm;
@@ -87,6 +91,7 @@ Config_t parse_args(int argc, char *argv[])
 	config.path.params 		= vm["pparams"].as<std::string>();
 	config.path.features	= vm["features"].as<std::string>();
 	config.path.output 		= vm["output"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
 	
 	return config; 
 }
@@ -13,6 +13,7 @@ struct Config_t {
 		std::string params;
 		std::string features;
 		std::string output;
+		std::string trace;
 	} path;
 };
 
@@ -36,8 +36,55 @@
 
 #include <pleno/io/images.h>
 
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/telemetry.h>
+#include <compote/log.h>
+#include <compote/render.h>
+#include <compote/pipeline.h>
+#include <compote/csv.h>
+#include <compote/codec.h>
+#include <compote/anytime.h>
+#include <compote/checkpoint.h>
+#include <compote/robust.h>
+
+//STD
+#include <map>
+#include <mutex>
+#include <cstdlib>
+
 #include "utils.h"
 
+//Save intrinsics, internal parameters and extrinsics
+void save_calibration(const Config_t& config, const PlenopticCamera& mfpc, const CalibrationPoses& poses)
+{
+	PRINT_WARN("\t... Saving Intrinsic Parameters");
+	save(config.path.output, mfpc);
+	
+	PRINT_WARN("\t... Saving Internal Parameters");
+	v::save(
+		"params.js", 
+		v::make_serializable(&(mfpc.params()))
+	);
+	
+	PRINT_WARN("\t... Saving Extrinsics Parameters");
+	CalibrationPosesConfig cfg_poses;
+	cfg_poses.poses().resize(poses.size());
+	
+	int i=0;
+	for(const auto& [p, f] : poses) {
+		LOG_IF(Printer::Level::DEBUG, 
+			Pose pc = to_coordinate_system_of(p, Pose{});
+			DEBUG_VAR(f); DEBUG_VAR(p); DEBUG_VAR(pc)
+		);
+		cfg_poses.poses()[i].pose() = p;
+		cfg_poses.poses()[i].frame() = f;
+		++i;
+	}
+	
+	v::save(config.path.extrinsics, cfg_poses);
+}
+
 int main(int argc, char* argv[])
 {
 	PRINT_INFO("========= Multifocus plenoptic camera calibration =========");
@@ -47,58 +94,53 @@ int main(int argc, char* argv[])
 	
 	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
 	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	if (config.async_log) compote::log::start();
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
+	if (config.path.telemetry != "") compote::telemetry::enable(config.path.telemetry);
+	
+	const compote::codec::Codec codec = compote::codec::select(config.codec);
+	
+	//without stages, a budget, plateau or checkpoint could only act on the single solve on every observation
+	compote::Schedule schedule = compote::Schedule::parse(config.schedule);
+	if (schedule.empty() and (config.budget > 0. or config.plateau > 0. or config.path.checkpoint != ""))
+	{
+		schedule = compote::Schedule::anytime();
+		PRINT_INFO("No schedule given, calibrating coarse-to-fine (--schedule 0.1,0.3)");
+	}
+	compote::Budget budget; budget.seconds = config.budget; budget.plateau = config.plateau;
+	std::map<std::string, compote::AnytimeReport> reports;
+	compote::RobustOptions robust;
+	robust.threshold = config.outliers; robust.loss = compote::parse_loss(config.loss); robust.rounds = config.irls;
+	
+	if (config.use_gui) compote::render::start(compote::render::Mode::Viewer);
+	else if (config.path.overlays != "") compote::render::start(compote::render::Mode::Headless, config.path.overlays);
 
 ////////////////////////////////////////////////////////////////////////////////
 // 1) Load Images from configuration file
 ////////////////////////////////////////////////////////////////////////////////
-	std::vector<ImageWithInfo> whites, checkerboards;
-	Image mask;
-	std::size_t imgformat = 8;
+	//Images are decoded on first access: whites only when MIA/params or centers have to be 
+	//computed, checkerboards when features have to be detected or pictures are built
+	compote::LazyImages images;
 	
+	TRACE_STEP("1) Load images");
 	if (config.path.images == "" and not(config.path.features == ""))
 	{
 		PRINT_WARN("1) No images loaded");
 	}
 	else
 	{
-		PRINT_WARN("1) Load Images from configuration file");
+		PRINT_WARN("1) Load Images configuration file (images are loaded when needed)");
 		ImagesConfig cfg_images;
 		v::load(config.path.images, cfg_images);
-		DEBUG_ASSERT((cfg_images.meta().rgb()), "Images must be in rgb format.");
-		DEBUG_ASSERT((cfg_images.meta().format() < 16), "Floating-point images not supported.");
-		
-		imgformat = cfg_images.meta().format();
 		
-		//1.1) Load whites images
-		PRINT_WARN("\t1.1) Load whites images");
-		load(cfg_images.whites(), whites, cfg_images.meta().debayered());
-		
-		DEBUG_ASSERT((whites.size() != 0u),	"You need to provide white images!");
-		
-		//1.2) Load checkerboard images
-		PRINT_WARN("\t1.2) Load checkerboard images");	
-		load(cfg_images.checkerboards(), checkerboards, cfg_images.meta().debayered());
-		
-		DEBUG_ASSERT((checkerboards.size() != 0u),	"You need to provide checkerboard images!");
-		
-		const double cbfnbr = checkerboards[0].fnumber;	
-		for (const auto& [ _ , fnumber, __ ] : checkerboards)
-		{
-			DEBUG_ASSERT((cbfnbr == fnumber), "All checkerboard images should have the same aperture configuration");
-		}
-		
-		//1.3) Load white image corresponding to the aperture (mask)
-		PRINT_WARN("\t1.3) Load white image corresponding to the aperture (mask)");
-		ImageWithInfo mask_;
-		load(cfg_images.mask(), mask_, cfg_images.meta().debayered());
-		
-		const auto [mimg, mfnbr, __] = mask_;
-		mask = mimg;
-		DEBUG_ASSERT((mfnbr == cbfnbr), "No corresponding f-number between mask and images");
+		images = compote::LazyImages{cfg_images};
 	}
+	const std::size_t imgformat = images.format();
 ////////////////////////////////////////////////////////////////////////////////
 // 2) Load Camera information from configuration file
 ////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("2) Load camera");
 	PRINT_WARN("2) Load Camera information from configuration file");
 	PlenopticCameraConfig cfg_camera;
 	v::load(config.path.camera, cfg_camera);
@@ -111,12 +153,12 @@ int main(int argc, char* argv[])
 	PRINT_WARN("\t2.2) MIA geometry parameters initialization");
     MIA mia{cfg_camera.mia()};
     
-    RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).name("mask"), mask);
     RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).pen_color(v::purple).pen_width(5).name("main:initialgrid(purple)"), mia);
     
 ////////////////////////////////////////////////////////////////////////////////
 // 3) Pre-calibration step
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("3) Pre-calibration");
 	PRINT_WARN("3) Pre-calibration");
 	InternalParameters params;
 	if(config.path.params == "") //no params available
@@ -126,23 +168,30 @@ int main(int argc, char* argv[])
 		PRINT_WARN("\t3.1) Compute micro-image centers");
 		MICObservations mic_obs;
 		
-		for(const auto& [img, fnumber, __] : whites)
+		for(const auto& [img, fnumber, __] : images.whites())
 		{
+			//fixed rule of this app; compote::precalibrate and the precalibrate app use the main-lens aperture and I
 			if(fnumber <= 4.) continue; //micro-images are overlapping
 			PRINT_INFO("=== Computing MIC in image f/" << fnumber);
+			TRACE_SCOPE("detection_mic");
 			MICObservations obs = detection_mic(img);
+			TRACE_COUNTER("mic observations per image", obs.size());
 			mic_obs.insert(std::end(mic_obs), std::begin(obs), std::end(obs));
 		
-			GUI(
-				RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).name("main:white_image_f/"+std::to_string(fnumber)), img);
-				for (const auto& o : obs)
-					RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()).name("main:observations(blue)").pen_color(v::blue).pen_width(5), P2D{o[0], o[1]});    
-				Viewer::update();
-			);
+			if (compote::render::enabled())
+			{
+				compote::render::Overlay overlay{"main:white_image_f/"+std::to_string(fnumber), img};
+				overlay.points.reserve(obs.size());
+				for (const auto& o : obs) overlay.points.emplace_back(o[0], o[1]);
+				compote::render::submit(std::move(overlay));
+			}
 		}	
 		//3.2) Optimization
 		PRINT_WARN("\t3.2) MIA geometry parameters calibration");
-		calibration_MIA(mia, mic_obs);
+		{
+			TRACE_SCOPE("3.2) calibration_MIA");
+			reports["mia"] = compote::calibrate_mia_anytime(mia, mic_obs, sensor.width(), sensor.height(), schedule, budget);
+		}
 	   
 		PRINT_DEBUG("Optimized MIA geometry parameters = \n" << mia);
 		RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).pen_color(v::green).pen_width(5).name("main:optimizedgrid(green)"), mia);
@@ -150,7 +199,8 @@ int main(int argc, char* argv[])
 
 		PRINT_WARN("3) Pre-calibration: Preprocessing white images and Computing internal parameters");
 		FORCE_GUI(true);
-		params = preprocess(whites, mia, sensor.scale(), cfg_camera.I(), cfg_camera.mode(), cfg_camera.main_lens().aperture());
+		TRACE_SCOPE("3.3) preprocess");
+		params = preprocess(images.whites(), mia, sensor.scale(), cfg_camera.I(), cfg_camera.mode(), cfg_camera.main_lens().aperture());
 		FORCE_GUI(false);
 		v::save("params-"+std::to_string(getpid())+".js", v::make_serializable(&params));
 	}
@@ -165,6 +215,7 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 4) Features extraction step
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("4) Features extraction");
 	PRINT_WARN("4) Features extraction");	
 	BAPObservations bap_obs;
 	MICObservations center_obs;	
@@ -173,18 +224,24 @@ int main(int argc, char* argv[])
 	{
 		//4.1) For each frame detect corners
 		PRINT_WARN("\t4.1) Computing BAP Features");
+		const Image& mask = images.mask();
+		RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).name("mask"), mask);
+		
 		std::size_t f = 0;
-		for (const auto& [ img, _, frame ] : checkerboards)
+		for (const auto& [ img, _, frame ] : images.checkerboards())
 		{					
-			PRINT_INFO("=== Devignetting image frame f = " << f);
+			TRACE_SCOPE("4.1) Detect frame");
+			LOG_INFO("=== Devignetting image frame f = " << f);
 			Image unvignetted;
 			
 			if (imgformat == 8) devignetting(img, mask, unvignetted);
 			else /* if (imgformat == 16) */ devignetting_u16(img, mask, unvignetted);
 				
-			PRINT_INFO("=== Detecting BAP Observation in image frame f = " << f);
+			LOG_INFO("=== Detecting BAP Observation in image frame f = " << f);
 			BAPObservations bapf = detection_bapfeatures(unvignetted, mia, params);
 			
+			TRACE_COUNTER("bap observations per frame", bapf.size());
+			
 			//assign frame index
 			std::for_each(
 				bapf.begin(), bapf.end(), 
@@ -204,7 +261,10 @@ int main(int argc, char* argv[])
 		}	
 		//4.2) Computing MIC Features
 		PRINT_WARN("\t4.2) Computing MIC Features");
-		center_obs = detection_mic(whites[1].img, cfg_camera.I());
+		{
+			TRACE_SCOPE("4.2) detection_mic");
+			center_obs = detection_mic(images.whites()[1].img, cfg_camera.I());
+		}
 		
 		//4.3) Saving Features
 		PRINT_WARN("\t4.3) Saving Features");
@@ -213,7 +273,7 @@ int main(int argc, char* argv[])
 			ObservationsConfig cfg_obs;
 			cfg_obs.features() = bap_obs;
 			cfg_obs.centers() = center_obs;			
-			v::save("observations-"+std::to_string(getpid())+".bin.gz", cfg_obs);
+			compote::codec::save(compote::codec::path("observations-"+std::to_string(getpid())+".bin", codec), cfg_obs);
 		}
 	}
 	else // features available
@@ -221,7 +281,7 @@ int main(int argc, char* argv[])
 		//5.3) Loading Features
 		PRINT_WARN("\t... Loading Features");
 		ObservationsConfig cfg_obs;
-		v::load(config.path.features, cfg_obs);
+		compote::csv::load(config.path.features, cfg_obs);
 
 		bap_obs = cfg_obs.features(); DEBUG_VAR(bap_obs.size());
 		center_obs = cfg_obs.centers(); DEBUG_VAR(center_obs.size());
@@ -229,9 +289,9 @@ int main(int argc, char* argv[])
 		if (center_obs.size() == 0u) 
 		{
 			//recompute centers
-			center_obs = detection_mic(whites[1].img, cfg_camera.I());
+			center_obs = detection_mic(images.whites()[1].img, cfg_camera.I());
 			cfg_obs.centers() = center_obs;	
-			v::save("updated-observations-"+std::to_string(getpid())+".bin.gz", cfg_obs);
+			compote::codec::save(compote::codec::path("updated-observations-"+std::to_string(getpid())+".bin", codec), cfg_obs);
 		}
 		
 		DEBUG_ASSERT(
@@ -243,6 +303,10 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 5) Starting Calibration of the MFPC
 ////////////////////////////////////////////////////////////////////////////////	
+	compote::trace::step_arg("bap observations", bap_obs.size());
+	compote::trace::step_arg("center observations", center_obs.size());
+	
+	TRACE_STEP("5) Calibration");
 	PRINT_WARN("5) Starting Calibration of the Plenoptic Camera");
 	//5.1) Loading Scene Model
 	PRINT_WARN("\t5.1) Loading Scene Model");
@@ -255,23 +319,35 @@ int main(int argc, char* argv[])
 	
 	CheckerBoard scene{cfg_scene.checkerboards()[0]};
 			
+	//Devignetted pictures are only consumed by the blur coefficient calibration (5.7) and by the
+	//display of the solvers in gui mode: they are built on first use, otherwise solvers get none
 	IndexedImages pictures;
-	
-	std::transform(
-		checkerboards.begin(), checkerboards.end(),
-		std::inserter(pictures, pictures.end()),
-		[&mask, &imgformat](const auto& iwi) -> auto { 
-			Image unvignetted;
-			
-			if (imgformat == 8) devignetting(iwi.img, mask, unvignetted);
-			else /* if (imgformat == 16) */ devignetting_u16(iwi.img, mask, unvignetted);
-			
-    		Image img = Image::zeros(unvignetted.rows, unvignetted.cols, CV_8UC1);
-			cv::cvtColor(unvignetted, img, cv::COLOR_BGR2GRAY);
-			return std::make_pair(iwi.frame, img); 
-		}	
-	);	
-
+	bool devignetted = false;
+	const auto devignetted_pictures = [&]() -> const IndexedImages& {
+		if (devignetted or not images.available()) return pictures;
+		devignetted = true;
+		
+		compote::trace::Scope scope{"5.1) Devignetting pictures"};
+		PRINT_WARN("\t5.1) Devignetting pictures");
+		const Image& mask = images.mask();
+		std::transform(
+			images.checkerboards().begin(), images.checkerboards().end(),
+			std::inserter(pictures, pictures.end()),
+			[&mask, &imgformat](const auto& iwi) -> auto { 
+				Image unvignetted;
+				
+				if (imgformat == 8) devignetting(iwi.img, mask, unvignetted);
+				else /* if (imgformat == 16) */ devignetting_u16(iwi.img, mask, unvignetted);
+				
+	    		Image img = Image::zeros(unvignetted.rows, unvignetted.cols, CV_8UC1);
+				cv::cvtColor(unvignetted, img, cv::COLOR_BGR2GRAY);
+				return std::make_pair(iwi.frame, img); 
+			}	
+		);
+		return pictures;
+	};
+	const IndexedImages none;
+	const IndexedImages& displayed = config.use_gui ? devignetted_pictures() : none;
 	
 	PRINT_WARN("\t5.2) Computing Initial Model");
 	PlenopticCamera mfpc; load(config.path.camera, mfpc);
@@ -285,14 +361,105 @@ int main(int argc, char* argv[])
 	}
 	PRINT_INFO("=== Initial Camera Parameters " << std::endl << "MFPC = " << mfpc);
 	save("initial-intrinsics-"+std::to_string(getpid())+".js", mfpc);
+	
+	if (robust.threshold > 0.)
+	{
+		PRINT_WARN("\t5.3) Flagging outliers (" << robust.threshold << " robust std. dev. per frame)");
+		const compote::Mask inliers = compote::prepass(mfpc, scene, bap_obs, displayed, robust);
+		if (config.path.inliers != "") compote::csv::write(config.path.inliers, bap_obs, inliers);
+		
+		bap_obs = compote::select(bap_obs, inliers);
+		compote::trace::step_arg("bap inliers", bap_obs.size());
+	}
 
-	PRINT_WARN("\t5.3) Calibrate");	
+	PRINT_WARN("\t5.4) Calibrate");	
 	CalibrationPoses poses;
-	calibration_PlenopticCamera(poses, mfpc, scene, bap_obs, center_obs, pictures);
+	{
+		compote::trace::Scope scope{"5.4) calibration_PlenopticCamera"};
+		scope.arg("bap observations", bap_obs.size());
+		scope.arg("center observations", center_obs.size());
+		
+		//best-so-far estimate, the initial model until a stage completes, saved if the budget expires
+		//during an optimization; the mutex also guards the reports, written by the watchdog
+		std::mutex mutex;
+		PlenopticCamera best = mfpc;
+		CalibrationPoses best_poses;
+		compote::AnytimeReport best_report;
+		std::string running = "calibration"; //optimization whose report is best_report
+		bool estimated = false; //a stage completed
+		
+		//stages completed by a previous (preempted) run
+		compote::AnytimeReport previous;
+		if (config.resume and config.path.checkpoint == "") PRINT_WARN("No checkpoint given (--checkpoint), nothing to resume");
+		if (config.resume and config.path.checkpoint != "")
+		{
+			if (auto state = compote::checkpoint::load(config.path.checkpoint, schedule, bap_obs.size(), center_obs.size()))
+			{
+				mfpc = state->mfpc; poses = state->poses; previous = state->report;
+				best = mfpc; best_poses = poses; best_report = previous; estimated = not previous.stages.empty();
+			}
+		}
+		const compote::StageCallback checkpoint = (config.path.checkpoint != "") ? 
+			compote::checkpoint::writer(config.path.checkpoint, schedule, bap_obs.size(), center_obs.size()) : compote::StageCallback{};
+		if (checkpoint and previous.stages.empty()) checkpoint(mfpc, poses, previous); //initial model, before the first stage
+		
+		compote::Watchdog watchdog{budget, [&]() {
+			std::lock_guard<std::mutex> lock{mutex};
+			if (not estimated) PRINT_ERR("Budget of " << budget.seconds << " s expired before any stage completed, saving the initial model (without poses)");
+			else PRINT_ERR("Budget of " << budget.seconds << " s expired, saving best-so-far parameters (" << best_report.stages.size() << " " << running << " stages completed)");
+			save_calibration(config, best, best_poses);
+			
+			best_report.reason = compote::StopReason::Budget;
+			best_report.seconds = budget.elapsed();
+			reports[running] = best_report;
+			if (config.path.report != "") compote::write_json(config.path.report, reports);
+			
+			compote::trace::flush();
+			compote::log::flush(); //_Exit does not stop the asynchronous writer
+			std::cout << std::flush; std::cerr << std::flush;
+			std::_Exit(2);
+		}};
+		
+		const compote::AnytimeReport report = compote::calibrate_anytime(poses, mfpc, scene, bap_obs, center_obs, displayed, schedule, budget,
+			[&](const PlenopticCamera& m, const CalibrationPoses& p, const compote::AnytimeReport& r) {
+				std::lock_guard<std::mutex> lock{mutex};
+				best = m; best_poses = p; best_report = r; estimated = true;
+				if (checkpoint) checkpoint(m, p, r);
+			},
+			previous
+		);
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			reports["calibration"] = report;
+		}
+		
+		PRINT_INFO("=== Calibration stopped (" << compote::to_string(report.reason) << ") after " << report.stages.size() 
+			<< " stages in " << report.seconds << " s, rmse = " << report.cost);
+		
+		if (robust.loss != compote::Loss::Squared and report.reason != compote::StopReason::Budget)
+		{
+			PRINT_WARN("\t5.5) Robust refinement (" << compote::to_string(robust.loss) << " loss, " << robust.rounds << " IRLS rounds)");
+			{
+				std::lock_guard<std::mutex> lock{mutex};
+				best = mfpc; best_poses = poses; best_report = compote::AnytimeReport{}; running = "irls";
+			}
+			
+			const compote::AnytimeReport rounds = compote::irls(poses, mfpc, scene, bap_obs, center_obs, displayed, robust, budget, report,
+				[&](const PlenopticCamera& m, const CalibrationPoses& p, const compote::AnytimeReport& r) {
+					std::lock_guard<std::mutex> lock{mutex};
+					best = m; best_poses = p; best_report = r;
+				}
+			);
+			
+			std::lock_guard<std::mutex> lock{mutex};
+			reports["irls"] = rounds;
+		}
+	}
+	if (config.path.report != "") compote::write_json(config.path.report, reports);
 
 	if (yes_no_question("Calibrate inverse distortion"))
 	{
-		PRINT_WARN("\t5.4) Starting Calibration of the inverse distortions");
+		PRINT_WARN("\t5.6) Starting Calibration of the inverse distortions");
 		
 		CheckerBoards boards; boards.reserve(poses.size());
 		for (const auto& [p, f] : poses)
@@ -302,51 +469,36 @@ int main(int argc, char* argv[])
 		}
 		
 		Distortions invdistortions;
-		calibration_inverseDistortions(invdistortions, mfpc, boards);
+		{
+			TRACE_SCOPE("5.6) calibration_inverseDistortions");
+			calibration_inverseDistortions(invdistortions, mfpc, boards);
+		}
 		
 		mfpc.main_lens_invdistortions() = invdistortions;
 	}
 	
 	if (mfpc.multifocus() and yes_no_question("Calibrate blur coefficient"))
 	{
-		PRINT_WARN("\t5.5) Starting Calibration of blur proportionnality coefficient");
+		PRINT_WARN("\t5.7) Starting Calibration of blur proportionnality coefficient");
 		
-		calibration_relativeBlur(mfpc.params(), bap_obs, pictures);
+		TRACE_SCOPE("5.7) calibration_relativeBlur");
+		calibration_relativeBlur(mfpc.params(), bap_obs, devignetted_pictures());
 	}
 
 ////////////////////////////////////////////////////////////////////////////////
 // 6) Save Calibration Parameters
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("6) Save");
 	PRINT_WARN("6) Save Calibration Parameters");
 	if(save()) 
 	{
-		PRINT_WARN("\t... Saving Intrinsic Parameters");
-		save(config.path.output, mfpc);
-		
-		PRINT_WARN("\t... Saving Internal Parameters");
-		v::save(
-			"params.js", 
-			v::make_serializable(&(mfpc.params()))
-		);
-		
-		PRINT_WARN("\t... Saving Extrinsics Parameters");
-		CalibrationPosesConfig cfg_poses;
-		cfg_poses.poses().resize(poses.size());
-		
-		int i=0;
-		for(const auto& [p, f] : poses) {
-			Pose pc = to_coordinate_system_of(p, Pose{});
-			DEBUG_VAR(f); DEBUG_VAR(p); DEBUG_VAR(pc);
-			cfg_poses.poses()[i].pose() = p;
-			cfg_poses.poses()[i].frame() = f;
-			++i;
-		}
-		
-		v::save(config.path.extrinsics, cfg_poses);
+		save_calibration(config, mfpc, poses);
 	}
 	
+	compote::trace::flush();
 	PRINT_INFO("========= EOF =========");
 
+	compote::render::stop();
 	Viewer::wait();
 	Viewer::stop();
 	return 0;
@@ -28,6 +28,10 @@ Config_t parse_args(int argc, char *argv[])
 			"Select level of output to print (can be combined):\n"
 			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
 		)
+		("async-log",
+			po::value<bool>()->default_value(false),
+			"Write output from a background thread, with timestamps and thread ids"
+		)
 		("pimages,i",
 			po::value<std::string>()->default_value(""),
 			"Path to images configuration file"
@@ -46,7 +50,7 @@ Config_t parse_args(int argc, char *argv[])
 		)
 		("features,f",
 			po::value<std::string>()->default_value(""),
-			"Path to observations file"
+			"Path to observations file, or comma-separated list of files (.csv features and/or centers)"
 		)
 		("extrinsics,e",
 			po::value<std::string>()->default_value("extrinsics.js"),
@@ -55,6 +59,69 @@ Config_t parse_args(int argc, char *argv[])
 		("output,o",
 			po::value<std::string>()->default_value("intrinsics.js"),
 			"Path to save intrinsics parameters file"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
+		)
+		("overlays",
+			po::value<std::string>()->default_value(""),
+			"Directory to write debug overlays (png) when the GUI is disabled, disabled if empty"
+		)
+		("codec",
+			po::value<std::string>()->default_value("gzip"),
+			"Compression codec of the saved observations: gzip (.bin.gz), zstd (.bin.zst) or lz4 (.bin.lz4)"
+		)
+		("schedule",
+			po::value<std::string>()->default_value(""),
+			"Coarse-to-fine calibration: comma-separated fractions of observations of the first stages (e.g., 0.1,0.3), "
+			"each stage starting from the previous estimate, the last one using every observation; disabled if empty"
+		)
+		("budget",
+			po::value<double>()->default_value(0.),
+			"Wall-clock budget (s) of the optimizations: stages predicted to exceed it are not started, and the best-so-far "
+			"parameters (the initial model if no stage completed) are saved (exit code 2) if it expires during one; "
+			"coarse-to-fine with --schedule 0.1,0.3 if no schedule is given; 0 for unlimited"
+		)
+		("plateau",
+			po::value<double>()->default_value(0.),
+			"Stop the coarse-to-fine stages when the relative decrease of the cost is below (--schedule 0.1,0.3 if no schedule "
+			"is given), 0 to disable"
+		)
+		("report",
+			po::value<std::string>()->default_value(""),
+			"Path to save the optimizations report (json): stop reason and statistics of each stage, disabled if empty"
+		)
+		("checkpoint",
+			po::value<std::string>()->default_value(""),
+			"Path to save a checkpoint (snapshot) of the initial model and of the calibration after each stage "
+			"(--schedule 0.1,0.3 if no schedule is given), disabled if empty"
+		)
+		("resume",
+			po::value<bool>()->default_value(false),
+			"Resume the calibration after the last stage of the checkpoint (an interrupted stage restarts from its beginning)"
+		)
+		("telemetry",
+			po::value<std::string>()->default_value(""),
+			"Stream convergence telemetry of the optimizations (JSONL) to a file or to a listening unix socket (unix:<path>), disabled if empty"
+		)
+		("outliers",
+			po::value<double>()->default_value(0.),
+			"Flag features whose error exceeds the median of their frame by more than this number of robust standard deviations "
+			"(after initialization), and leave them out of the calibration; 0 to disable"
+		)
+		("inliers",
+			po::value<std::string>()->default_value(""),
+			"Path to save the features with their inlier mask (csv) after the outliers pre-pass, disabled if empty"
+		)
+		("loss",
+			po::value<std::string>()->default_value("squared"),
+			"Loss of the calibration: squared, or huber/cauchy for a robust refinement by IRLS"
+		)
+		("irls",
+			po::value<std::size_t>()->default_value(2),
+			"Number of IRLS rounds of the robust refinement, each one being a full calibration solve run after "
+			"convergence (within the budget)"
 		);
 
 	po::variables_map vm;
@@ -98,6 +165,15 @@ Config_t parse_args(int argc, char *argv[])
 	config.use_gui 	 		= vm["gui"].as<bool>();
 	config.verbose			= vm["verbose"].as<bool>();
 	config.level			= vm["level"].as<std::uint16_t>();
+	config.async_log		= vm["async-log"].as<bool>();
+	config.codec			= vm["codec"].as<std::string>();
+	config.schedule			= vm["schedule"].as<std::string>();
+	config.budget			= vm["budget"].as<double>();
+	config.plateau			= vm["plateau"].as<double>();
+	config.resume			= vm["resume"].as<bool>();
+	config.outliers			= vm["outliers"].as<double>();
+	config.loss				= vm["loss"].as<std::string>();
+	config.irls				= vm["irls"].as<std::size_t>();
 	config.path.images 		= vm["pimages"].as<std::string>();
 	config.path.camera 		= vm["pcamera"].as<std::string>();
 	config.path.params 		= vm["pparams"].as<std::string>();
@@ -105,6 +181,12 @@ Config_t parse_args(int argc, char *argv[])
 	config.path.features	= vm["features"].as<std::string>();
 	config.path.extrinsics	= vm["extrinsics"].as<std::string>();
 	config.path.output 		= vm["output"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
+	config.path.telemetry	= vm["telemetry"].as<std::string>();
+	config.path.report		= vm["report"].as<std::string>();
+	config.path.checkpoint	= vm["checkpoint"].as<std::string>();
+	config.path.inliers		= vm["inliers"].as<std::string>();
+	config.path.overlays	= vm["overlays"].as<std::string>();
 	
 	return config; 
 }
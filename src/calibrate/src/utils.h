@@ -7,6 +7,15 @@ struct Config_t {
 	bool use_gui;
 	bool verbose;
 	std::uint16_t level;
+	bool async_log;
+	std::string codec; //of the saved observations
+	std::string schedule; //coarse-to-fine fractions of observations
+	double budget; //wall-clock budget (s), 0 for unlimited
+	double plateau; //relative decrease of the cost between stages below which to stop, 0 to disable
+	bool resume; //from the checkpoint
+	double outliers; //pre-pass threshold (robust std. dev.), 0 to disable
+	std::string loss; //of the robust refinement
+	std::size_t irls; //rounds of the robust refinement
 	
 	struct {
 		std::string images;
@@ -16,6 +25,12 @@ struct Config_t {
 		std::string features;
 		std::string extrinsics;
 		std::string output;
+		std::string trace;
+		std::string telemetry;
+		std::string overlays;
+		std::string report;
+		std::string checkpoint;
+		std::string inliers;
 	} path;
 };
 
@@ -0,0 +1,50 @@
+//STD
+#include <iostream>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/io/printer.h>
+
+#include <pleno/geometry/observation.h>
+#include <pleno/io/cfg/observations.h>
+
+//COMPOTE
+#include <compote/csv.h>
+#include <compote/codec.h>
+
+#include "utils.h"
+
+int main(int argc, char* argv[])
+{
+	PRINT_INFO("========= Observations conversion =========");
+	Config_t config = parse_args(argc, argv);
+	
+	Printer::verbose(config.verbose);
+	Printer::level(config.level);
+	
+	PRINT_WARN("1) Load observations from " << config.path.input);
+	ObservationsConfig cfg_obs;
+	compote::csv::load(config.path.input, cfg_obs, config.threads);
+	PRINT_INFO("\tfeatures: " << cfg_obs.features().size() << ", centers: " << cfg_obs.centers().size());
+	
+	PRINT_WARN("2) Save observations");
+	if (config.path.output != "")
+	{
+		PRINT_INFO("\tobservations: " << config.path.output);
+		compote::codec::save(config.path.output, cfg_obs, {0, config.threads});
+	}
+	if (config.path.features != "")
+	{
+		PRINT_INFO("\tfeatures: " << config.path.features);
+		compote::csv::write(config.path.features, cfg_obs.features(), config.threads);
+	}
+	if (config.path.centers != "")
+	{
+		PRINT_INFO("\tcenters: " << config.path.centers);
+		compote::csv::write(config.path.centers, cfg_obs.centers(), config.threads);
+	}
+	
+	PRINT_INFO("========= EOF =========");
+	return 0;
+}
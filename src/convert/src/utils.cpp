@@ -0,0 +1,93 @@
+#include "utils.h"
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(true),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ALL),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("input,i",
+			po::value<std::string>()->default_value(""),
+			"Path to observations file, or comma-separated list of files (.csv features and/or centers)"
+		)
+		("output,o",
+			po::value<std::string>()->default_value(""),
+			"Path to the output observations file, compressed according to its extension (.bin.gz, .bin.zst, .bin.lz4)"
+		)
+		("features,f",
+			po::value<std::string>()->default_value(""),
+			"Path to the output csv file of BAP features"
+		)
+		("centers,c",
+			po::value<std::string>()->default_value(""),
+			"Path to the output csv file of micro-image centers"
+		)
+		("threads,j",
+			po::value<std::size_t>()->default_value(0),
+			"Number of threads used to parse and format csv files (0 for hardware concurrency)"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "Observations conversion:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	//check if hepl or no arguments then display usage
+	if (vm.count("help") or argc==1)
+	{
+		/* print usage */
+		std::cout << "Observations conversion:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check mandatory parameters
+	if(vm["input"].as<std::string>() == "" 
+		or (vm["output"].as<std::string>() == "" and vm["features"].as<std::string>() == "" and vm["centers"].as<std::string>() == "")
+	)
+	{
+		/* print usage */
+		std::cerr << "Please specify the input observations and at least one output. " << std::endl;
+		std::cout << "Observations conversion:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	Config_t config;
+	
+	config.verbose			= vm["verbose"].as<bool>();
+	config.level			= vm["level"].as<std::uint16_t>();
+	config.threads			= vm["threads"].as<std::size_t>();
+	config.path.input 		= vm["input"].as<std::string>();
+	config.path.output 		= vm["output"].as<std::string>();
+	config.path.features	= vm["features"].as<std::string>();
+	config.path.centers		= vm["centers"].as<std::string>();
+	
+	return config; 
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	std::size_t threads; //0 for hardware concurrency
+	
+	struct {
+		std::string input; //comma-separated list of observations files
+		std::string output; //ObservationsConfig (e.g., .bin.gz)
+		std::string features; //csv
+		std::string centers; //csv
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);
@@ -36,6 +36,11 @@ namespace fs = std::experimental::filesystem;
 
 #include <pleno/io/images.h>
 
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/log.h>
+#include <compote/codec.h>
+
 #include "utils.h"
 
 int main(int argc, char* argv[])
@@ -47,12 +52,18 @@ int main(int argc, char* argv[])
 	
 	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
 	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	if (config.async_log) compote::log::start();
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
+	
+	const compote::codec::Codec codec = compote::codec::select(config.codec);
 	
 	fs::create_directories("obs");
 
 ////////////////////////////////////////////////////////////////////////////////
 // 1) Load Images from configuration file
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("1) Load images");
 	PRINT_WARN("1) Load Images from configuration file");
 	ImagesConfig cfg_images;
 	v::load(config.path.images, cfg_images);
@@ -90,6 +101,7 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 2) Load Camera information from configuration file
 ////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("2) Load camera");
 	PRINT_WARN("2) Load Camera information from configuration file");
 	PlenopticCameraConfig cfg_camera;
 	v::load(config.path.camera, cfg_camera);
@@ -112,6 +124,7 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 3) Detect Features
 ////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("3) Detect features");
 	PRINT_WARN("3) Detect features in images");
 	BAPObservations bap_obs;
 	MICObservations center_obs;	
@@ -122,14 +135,20 @@ int main(int argc, char* argv[])
 	{		
 		std::size_t f = (frame != -1) ? frame : f_;
 		
-		PRINT_INFO("=== Devignetting image frame f = " << f);
+		compote::trace::Scope scope{"3.1) Detect frame"};
+		scope.arg("frame", f);
+		
+		LOG_INFO("=== Devignetting image frame f = " << f);
 		Image unvignetted;	
 		if (cfg_images.meta().format() == 8u) devignetting(img, mask, unvignetted);
 		else /* if (cfg_images.meta().format() == 16u) */ devignetting_u16(img, mask, unvignetted);
 			
-		PRINT_INFO("=== Detecting BAP Observation in image frame f = " << f);
+		LOG_INFO("=== Detecting BAP Observation in image frame f = " << f);
 		BAPObservations bapf = detection_bapfeatures(unvignetted, mia, params);
 		
+		scope.arg("bap observations", bapf.size());
+		TRACE_COUNTER("bap observations per frame", bapf.size());
+		
 		//assign frame index
 		std::for_each(bapf.begin(), bapf.end(), [&f](BAPObservation& cbo) { cbo.frame = f; });
 		
@@ -137,7 +156,7 @@ int main(int argc, char* argv[])
 		{
 			ObservationsConfig cfg_obs;
 			cfg_obs.features() = bapf;
-			v::save("obs/bap-observations-"+std::to_string(getpid())+"-frame-"+std::to_string(f)+".bin.gz", cfg_obs);
+			compote::codec::save(compote::codec::path("obs/bap-observations-"+std::to_string(getpid())+"-frame-"+std::to_string(f)+".bin", codec), cfg_obs);
 		}
 			
 		//update observations				
@@ -150,7 +169,7 @@ int main(int argc, char* argv[])
 		{
 			ObservationsConfig cfg_obs;
 			cfg_obs.features() = bap_obs;
-			v::save("obs/bap-observations-"+std::to_string(getpid())+"-frame-x-to-"+std::to_string(f)+".bin.gz", cfg_obs);
+			compote::codec::save(compote::codec::path("obs/bap-observations-"+std::to_string(getpid())+"-frame-x-to-"+std::to_string(f)+".bin", codec), cfg_obs);
 		}	
 		
 		++f_;
@@ -159,22 +178,30 @@ int main(int argc, char* argv[])
 	}	
 	//5.4) Computing MIC Features
 	PRINT_WARN("\t3.2) Computing MIC Features");
-	center_obs = detection_mic(whites[1].img, cfg_camera.I());
+	{
+		TRACE_SCOPE("3.2) detection_mic");
+		center_obs = detection_mic(whites[1].img, cfg_camera.I());
+	}
 		
 	//save centers observations
 	{
 		ObservationsConfig cfg_obs;
 		cfg_obs.centers() = center_obs;
-		v::save("obs/centers-observations-"+std::to_string(getpid())+".bin.gz", cfg_obs);
+		compote::codec::save(compote::codec::path("obs/centers-observations-"+std::to_string(getpid())+".bin", codec), cfg_obs);
 	}
 		
 	//5.5) Saving Features
+	compote::trace::step_arg("bap observations", bap_obs.size());
+	compote::trace::step_arg("center observations", center_obs.size());
+	
+	TRACE_STEP("3.3) Save features");
 	PRINT_WARN("\t3.3) Saving Features");
 	ObservationsConfig cfg_obs;
 	cfg_obs.features() = bap_obs;
 	cfg_obs.centers() = center_obs;			
-	v::save("observations-"+std::to_string(getpid())+".bin.gz", cfg_obs);
+	compote::codec::save(compote::codec::path("observations-"+std::to_string(getpid())+".bin", codec), cfg_obs);
 	
+	compote::trace::flush();
 	PRINT_INFO("========= EOF =========");
 
 	Viewer::wait();
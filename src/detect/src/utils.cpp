@@ -28,6 +28,10 @@ Config_t parse_args(int argc, char *argv[])
 			"Select level of output to print (can be combined):\n"
 			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
 		)
+		("async-log",
+			po::value<bool>()->default_value(false),
+			"Write output from a background thread, with timestamps and thread ids"
+		)
 		("pimages,i",
 			po::value<std::string>()->default_value(""),
 			"Path to images configuration file"
@@ -43,6 +47,14 @@ Config_t parse_args(int argc, char *argv[])
 		("features,f",
 			po::value<std::string>()->default_value("observations.bin.gz"),
 			"Path to save observations file"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
+		)
+		("codec",
+			po::value<std::string>()->default_value("gzip"),
+			"Compression codec of the saved observations: gzip (.bin.gz), zstd (.bin.zst) or lz4 (.bin.lz4)"
 		);
 
 	po::variables_map vm;
@@ -85,10 +97,13 @@ Config_t parse_args(int argc, char *argv[])
 	config.use_gui 	 		= vm["gui"].as<bool>();
 	config.verbose			= vm["verbose"].as<bool>();
 	config.level			= vm["level"].as<std::uint16_t>();
+	config.async_log		= vm["async-log"].as<bool>();
+	config.codec			= vm["codec"].as<std::string>();
 	config.path.images 		= vm["pimages"].as<std::string>();
 	config.path.camera 		= vm["pcamera"].as<std::string>();
 	config.path.params 		= vm["pparams"].as<std::string>();
 	config.path.features	= vm["features"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
 	
 	return config; 
 }
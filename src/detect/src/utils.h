@@ -7,12 +7,15 @@ struct Config_t {
 	bool use_gui;
 	bool verbose;
 	std::uint16_t level;
+	bool async_log;
+	std::string codec; //of the saved observations
 	
 	struct {
 		std::string images;
 		std::string camera;
 		std::string params;
 		std::string features;
+		std::string trace;
 	} path;
 };
 
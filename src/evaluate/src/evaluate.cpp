@@ -0,0 +1,188 @@
+//STD
+#include <iostream>
+#include <fstream>
+#include <cmath>
+//EIGEN
+//BOOST
+//OPENCV
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/io/printer.h>
+
+//geometry
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+//config
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/scene.h>
+#include <pleno/io/cfg/observations.h>
+#include <pleno/io/cfg/poses.h>
+
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/snapshot.h>
+#include <compote/residuals.h>
+#include <compote/csv.h>
+#include <compote/lookup.h>
+
+#include "utils.h"
+
+int main(int argc, char* argv[])
+{
+	PRINT_INFO("========= Multifocus plenoptic camera reprojection error evaluation =========");
+	Config_t config = parse_args(argc, argv);
+	
+	Printer::verbose(config.verbose);
+	Printer::level(config.level);
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
+	
+	compote::ResidualsOptions options;
+	options.threads = config.threads;
+	options.zones 	= config.zones;
+	options.bins 	= config.bins;
+	options.max 	= config.max;
+////////////////////////////////////////////////////////////////////////////////	
+// 1) Load Camera, Scene and Poses from configuration files
+////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("1) Load configurations");
+	PRINT_WARN("1) Load Camera, Scene and Poses from configuration files");
+	PlenopticCamera mfpc;
+	compote::snapshot::load(config.path.camera, config.path.params, mfpc);
+	
+	const bool with_bap = (config.path.scene != "" and config.path.extrinsics != "");
+	
+	SceneConfig cfg_scene;
+	CalibrationPoses poses;
+	if (with_bap)
+	{
+		v::load(config.path.scene, cfg_scene);
+		DEBUG_ASSERT((cfg_scene.checkerboards().size() > 0u), "No checkerboard model provided.");
+		
+		CalibrationPosesConfig cfg_poses;
+		v::load(config.path.extrinsics, cfg_poses);
+		for (const auto& cfg_pose : cfg_poses.poses()) 
+			poses.emplace_back(CalibrationPose{cfg_pose.pose(), cfg_pose.frame()});
+	}
+	else
+	{
+		PRINT_WARN("\tNo scene or poses given, only micro-image centers are evaluated");
+	}
+////////////////////////////////////////////////////////////////////////////////	
+// 2) Loading Features
+////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("2) Load features");
+	PRINT_WARN("2) Loading Features");
+	ObservationsConfig cfg_obs;
+	compote::csv::load(config.path.features, cfg_obs);
+	
+	const BAPObservations bap_obs = cfg_obs.features();
+	const MICObservations center_obs = cfg_obs.centers();
+	
+	compote::trace::step_arg("bap observations", bap_obs.size());
+	compote::trace::step_arg("center observations", center_obs.size());
+////////////////////////////////////////////////////////////////////////////////	
+// 3) Compute residuals and statistics
+////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("3) Residuals");
+	PRINT_WARN("3) Compute residuals and statistics");
+	compote::Residuals bap, centers;
+	compote::ResidualsReport bap_report, centers_report;
+	
+	if (with_bap)
+	{
+		compote::trace::Scope scope{"3.1) BAP residuals"};
+		const CheckerBoard scene{cfg_scene.checkerboards()[0]};
+		bap = compote::bap_residuals(mfpc, scene, poses, bap_obs, options);
+		bap_report = compote::aggregate(bap, options);
+		scope.arg("residuals", bap.size());
+		
+		PRINT_INFO("\tBAP: n = " << bap_report.all.n << ", invalid = " << bap_report.invalid 
+			<< ", rmse = " << bap_report.all.rmse() << ", rmse(rho) = " << bap_report.all.rmse_rho()
+			<< ", max = " << bap_report.all.max);
+	}
+	{
+		compote::trace::Scope scope{"3.2) Centers residuals"};
+		centers = compote::center_residuals(mfpc, center_obs, options);
+		centers_report = compote::aggregate(centers, options);
+		scope.arg("residuals", centers.size());
+		
+		PRINT_INFO("\tCenters: n = " << centers_report.all.n << ", invalid = " << centers_report.invalid 
+			<< ", rmse = " << centers_report.all.rmse() << ", max = " << centers_report.all.max);
+	}
+	
+	//observations lying outside the disk of the micro-image (k,l) they are attributed to
+	std::size_t bap_misattributed = 0, centers_misattributed = 0;
+	{
+		compote::trace::Scope scope{"3.3) Micro-image ownership"};
+		//read-only: the map stored by precalibrate if it corresponds to the MIA, otherwise each observation
+		//is tested against the disk of its micro-image (within it, the micro-image is also the closest one)
+		const MIA& mia = mfpc.mia();
+		const std::size_t cols = mfpc.sensor().width(), rows = mfpc.sensor().height();
+		
+		compote::MicroImageMap map;
+		const bool stored = map.load(compote::MicroImageMap::path_for(config.path.params)) and map.matches(mia, mfpc.I(), cols, rows);
+		if (not stored) PRINT_INFO("\tNo pixel to micro-image map stored with the internal parameters, testing against the MIA");
+		
+		const double radius = 0.5 * mia.diameter();
+		auto misattributed = [&](const auto& observations) -> std::size_t {
+			std::size_t n = 0;
+			if (stored)
+			{
+				std::vector<P2D> points; points.reserve(observations.size());
+				for (const auto& o : observations) points.emplace_back(o.u, o.v);
+				
+				std::vector<compote::Owner> owners;
+				map.lookup(points, owners);
+				
+				for (std::size_t i = 0; i < observations.size(); ++i)
+					if (not owners[i].inside or owners[i].k != int(observations[i].k) or owners[i].l != int(observations[i].l)) ++n;
+				return n;
+			}
+			
+			for (const auto& o : observations)
+			{
+				const long u = std::lround(o.u), v = std::lround(o.v); //pixel, as in the map
+				if (o.k < 0 or o.l < 0 or std::size_t(o.k) >= mia.width() or std::size_t(o.l) >= mia.height()
+					or u < 0 or v < 0 or std::size_t(u) >= cols or std::size_t(v) >= rows) { ++n; continue; }
+				
+				const P2D c = mia.nodeInWorld(o.k, o.l);
+				if (std::hypot(u - c[0], v - c[1]) > radius) ++n;
+			}
+			return n;
+		};
+		bap_misattributed = misattributed(bap_obs);
+		centers_misattributed = misattributed(center_obs);
+		
+		PRINT_INFO("\tOutside of their micro-image: " << bap_misattributed << " BAP features, " << centers_misattributed << " centers");
+	}
+////////////////////////////////////////////////////////////////////////////////	
+// 4) Save report
+////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("4) Save");
+	PRINT_WARN("4) Save report in " << config.path.output);
+	{
+		std::ofstream ofs(config.path.output);
+		ofs << "{\n\t\"bap\": ";
+		if (with_bap) compote::write_json(ofs, bap_report, options, "\t");
+		else ofs << "null";
+		ofs << ",\n\t\"centers\": ";
+		compote::write_json(ofs, centers_report, options, "\t");
+		ofs << ",\n\t\"misattributed\": {\"bap\": " << bap_misattributed << ", \"centers\": " << centers_misattributed << "}";
+		ofs << "\n}\n";
+	}
+	
+	if (config.path.dump != "")
+	{
+		PRINT_WARN("\tDump residuals in " << config.path.dump);
+		if (with_bap) compote::save_columns(config.path.dump + "/bap", bap);
+		compote::save_columns(config.path.dump + "/centers", centers);
+	}
+	
+	compote::trace::flush();
+	PRINT_INFO("========= EOF =========");
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include "utils.h"
+
+#include <cmath>
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(true),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ALL),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("pcamera,c",
+			po::value<std::string>()->default_value(""),
+			"Path to camera configuration file"
+		)
+		("pparams,p",
+			po::value<std::string>()->default_value(""),
+			"Path to camera internal parameters configuration file"
+		)
+		("pscene,s",
+			po::value<std::string>()->default_value(""),
+			"Path to scene configuration file"
+		)
+		("features,f",
+			po::value<std::string>()->default_value(""),
+			"Path to observations file, or comma-separated list of files (.csv features and/or centers)"
+		)
+		("extrinsics,e",
+			po::value<std::string>()->default_value(""),
+			"Path to extrinsics parameters file"
+		)
+		("output,o",
+			po::value<std::string>()->default_value("residuals.json"),
+			"Path to save the residuals report (json)"
+		)
+		("dump,d",
+			po::value<std::string>()->default_value(""),
+			"Directory to dump per-observation residuals by column, disabled if empty"
+		)
+		("jobs,j",
+			po::value<std::size_t>()->default_value(0),
+			"Number of threads (0 = hardware concurrency)"
+		)
+		("zones",
+			po::value<std::size_t>()->default_value(5),
+			"Number of radial zones on the sensor"
+		)
+		("bins",
+			po::value<std::size_t>()->default_value(40),
+			"Number of bins of the error histograms"
+		)
+		("max",
+			po::value<double>()->default_value(2.),
+			"Range of the error histograms (pixel, > 0)"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "Reprojection error evaluation:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	//check if hepl or no arguments then display usage
+	if (vm.count("help") or argc==1)
+	{
+		/* print usage */
+		std::cout << "Reprojection error evaluation:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check mandatory parameters
+	if(	vm["pcamera"].as<std::string>() == ""
+		or vm["pparams"].as<std::string>() == ""
+		or vm["features"].as<std::string>() == ""
+	)
+	{
+		/* print usage */
+		std::cerr << "Please specify at the configuration files. " << std::endl;
+		std::cout << "Reprojection error evaluation:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check the histogram range
+	if (not std::isfinite(vm["max"].as<double>()) or vm["max"].as<double>() <= 0.)
+	{
+		std::cerr << "The histogram range (--max) must be a positive number of pixels. " << std::endl;
+		exit(1);
+	}
+	
+	Config_t config;
+	
+	config.verbose			= vm["verbose"].as<bool>();
+	config.level			= vm["level"].as<std::uint16_t>();
+	config.threads			= vm["jobs"].as<std::size_t>();
+	config.zones			= std::max<std::size_t>(1, vm["zones"].as<std::size_t>());
+	config.bins				= std::max<std::size_t>(1, vm["bins"].as<std::size_t>());
+	config.max				= vm["max"].as<double>();
+	config.path.camera 		= vm["pcamera"].as<std::string>();
+	config.path.params 		= vm["pparams"].as<std::string>();
+	config.path.scene 		= vm["pscene"].as<std::string>();
+	config.path.features	= vm["features"].as<std::string>();
+	config.path.extrinsics	= vm["extrinsics"].as<std::string>();
+	config.path.output		= vm["output"].as<std::string>();
+	config.path.dump		= vm["dump"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
+	
+	return config; 
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	std::size_t threads;
+	std::size_t zones;
+	std::size_t bins;
+	double max;
+	
+	struct {
+		std::string camera;
+		std::string params;
+		std::string scene;
+		std::string features;
+		std::string extrinsics;
+		std::string output;
+		std::string dump;
+		std::string trace;
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);
@@ -35,6 +35,15 @@
 
 #include <pleno/io/images.h>
 
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/telemetry.h>
+#include <compote/log.h>
+#include <compote/snapshot.h>
+#include <compote/csv.h>
+#include <compote/anytime.h>
+#include <compote/residuals.h>
+
 #include "utils.h"
 
 int main(int argc, char* argv[])
@@ -46,20 +55,22 @@ int main(int argc, char* argv[])
 	
 	Printer::verbose(config.verbose);
 	Printer::level(config.level);
+	if (config.async_log) compote::log::start();
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
+	if (config.path.telemetry != "") compote::telemetry::enable(config.path.telemetry);
 ////////////////////////////////////////////////////////////////////////////////	
 // 1) Load Camera information from configuration file
 ////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("1) Load camera");
 	PRINT_WARN("1) Load Camera information from configuration file");
 	PlenopticCamera mfpc;
-	load(config.path.camera, mfpc);
-	
-	InternalParameters params;
-	v::load(config.path.params, v::make_serializable(&params));
-	mfpc.params() = params;
+	compote::snapshot::load(config.path.camera, config.path.params, mfpc);
 	
 ////////////////////////////////////////////////////////////////////////////////		
 // 2) Load images from configuration file
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("2) Load images");
 	IndexedImages pictures;
 	if (config.path.images == "")
 	{
@@ -101,15 +112,21 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////	
 // 3) Loading Features
 ////////////////////////////////////////////////////////////////////////////////	
+	compote::trace::step_arg("images", pictures.size());
+	
+	TRACE_STEP("3) Load features");
 	PRINT_WARN("3) Loading BAP Features");
 	ObservationsConfig cfg_obs;
-	v::load(config.path.features, cfg_obs);
+	compote::csv::load(config.path.features, cfg_obs);
 		
 	BAPObservations bap_obs = cfg_obs.features();
 
 ////////////////////////////////////////////////////////////////////////////////	
 // 4) Starting Evaluation of the MutliFocus Plenoptic Camera Calibration
 ////////////////////////////////////////////////////////////////////////////////	
+	compote::trace::step_arg("bap observations", bap_obs.size());
+	
+	TRACE_STEP("4) Extrinsics");
 	PRINT_WARN("4) Starting Evaluation of the MutliFocus Plenoptic Camera Calibration");
 	//4.1) Loading Scene Model
 	PRINT_WARN("\t4.1) Loading Scene Model");
@@ -121,8 +138,30 @@ int main(int argc, char* argv[])
 	
 	PRINT_WARN("\t4.2) Calibrate Extrinsics");
 	CalibrationPoses poses;
-	calibration_ExtrinsicsPlenopticCamera(poses, mfpc, scene, bap_obs, pictures);
+	{
+		compote::trace::Scope scope{"4.2) calibration_ExtrinsicsPlenopticCamera"};
+		scope.arg("bap observations", bap_obs.size());
+		if (config.budget > 0.)
+		{
+			compote::Budget budget; budget.seconds = config.budget;
+			const auto report = compote::extrinsics_anytime(poses, mfpc, scene, bap_obs, pictures, budget);
+			PRINT_INFO("Extrinsics stopped (" << compote::to_string(report.reason) << ") after " << report.stages.size() 
+				<< " batches in " << report.seconds << " s, " << poses.size() << " poses");
+		}
+		else
+		{
+			compote::telemetry::Solve solve{"extrinsics", {{"observations", double(bap_obs.size())}}};
+			calibration_ExtrinsicsPlenopticCamera(poses, mfpc, scene, bap_obs, pictures);
+			if (compote::telemetry::enabled())
+			{
+				const double cost = compote::aggregate(compote::bap_residuals(mfpc, scene, poses, bap_obs)).all.rmse();
+				solve.close({{"cost", cost}, {"observations", double(bap_obs.size())}});
+			}
+		}
+		scope.arg("poses", poses.size());
+	}
 	
+	TRACE_STEP("5) Save");
 	PRINT_WARN("\t6.3) Save Extrinsics Poses");
 	if(save()) 
 	{
@@ -131,7 +170,7 @@ int main(int argc, char* argv[])
 		
 		int i=0;
 		for(const auto& [p, f] : poses) {
-			DEBUG_VAR(f); DEBUG_VAR(p); 
+			LOG_VAR(f); LOG_VAR(p);
 			cfg_poses.poses()[i].pose() = p;
 			cfg_poses.poses()[i].frame() = f;
 			++i;
@@ -140,6 +179,7 @@ int main(int argc, char* argv[])
 		v::save(config.path.extrinsics, cfg_poses);
 	}
 	
+	compote::trace::flush();
 	PRINT_INFO("========= EOF =========");
 
 	Viewer::wait();
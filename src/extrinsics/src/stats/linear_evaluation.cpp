@@ -1,6 +1,8 @@
 //STD
 #include <iostream>
 #include <unistd.h>
+#include <thread>
+#include <atomic>
 
 //EIGEN
 
@@ -37,22 +39,16 @@
 #include <pleno/io/cfg/poses.h>
 
 #include "utils.h"
+#include "statistics.h"
 
 
-int main(int argc, char* argv[])
+//Positions along z of the poses, sorted by frame index
+std::vector<double> load_z(const std::string& path)
 {
-	PRINT_INFO("========= Multifocus plenoptic camera poses statistics =========");
-	Config_t config = parse_args(argc, argv);
-	
-	Printer::verbose(config.verbose);
-	Printer::level(config.level);
-	
-	CalibrationPoses poses;
-	PRINT_WARN("Loading Calibration Poses");
 	CalibrationPosesConfig cfg_poses;
+	v::load(path, cfg_poses);
 	
-	v::load(config.path.extrinsics, cfg_poses);
-			
+	CalibrationPoses poses;
 	poses.reserve(cfg_poses.poses().size());
 	for(const auto& cfg_pose : cfg_poses.poses()) 
 	{
@@ -69,71 +65,51 @@ int main(int argc, char* argv[])
 		}
 	);
 	
-	PRINT_INFO("Enter Ground Truth Displacement : ");
-	double dz_gt = 0.;
-	std::cin >> dz_gt;
+	std::vector<double> z; z.reserve(poses.size());
+	for (const auto& p : poses) z.emplace_back(p.pose.translation()[2]);
 	
-	{//ABSOLUTE
-		std::vector<double> dists;
-		std::transform(
-			poses.begin(), poses.end()-1,
-			poses.begin()+1, 
-			std::back_inserter(dists),
-		    [](const auto& p1, const auto& p2) -> double { 
-		    	return std::fabs(p1.pose.translation()[2] - p2.pose.translation()[2]); 
-		    }
-		);
-		
-		PRINT_INFO("Delta_Z = ");
-		std::ostringstream oss;
-		for(auto&d : dists) oss << d << " mm" << std::endl;
-		PRINT_INFO(oss.str());
-		
-		double sum = std::accumulate(dists.begin(), dists.end(), 0.0);
-		double mean = sum / dists.size();
-		
-		PRINT_INFO("Mean Dz = " << mean);
+	return z;
+}
 
-		std::vector<double> diff(dists.size());
-		std::transform(
-			dists.begin(), dists.end(), diff.begin(),
-			[&mean](double x) { return x - mean; }
-		);
-		double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-		double stdev = std::sqrt(sq_sum / dists.size());
-		
-		PRINT_INFO("Stdev Dz = " << stdev);
+int main(int argc, char* argv[])
+{
+	PRINT_INFO("========= Multifocus plenoptic camera poses statistics =========");
+	Config_t config = parse_args(argc, argv);
+	
+	Printer::verbose(config.verbose);
+	Printer::level(config.level);
+	
+	double dz_gt = config.gt;
+	if (dz_gt <= 0.)
+	{
+		PRINT_INFO("Enter Ground Truth Displacement : ");
+		std::cin >> dz_gt;
 	}
-	{//RELATIVE
-		std::vector<double> dists;
-		std::transform(
-			poses.begin(), poses.end()-1,
-			poses.begin()+1, 
-			std::back_inserter(dists),
-		    [&dz_gt](const auto& p1, const auto& p2) -> double { 
-		    	return 100. * std::fabs(dz_gt - std::fabs(p1.pose.translation()[2] - p2.pose.translation()[2])) / dz_gt; 
-		    }
-		);
-		
-		PRINT_INFO("Delta_Z = ");
-		std::ostringstream oss;
-		for(auto&d : dists) oss << d << "%" << std::endl;
-		PRINT_INFO(oss.str());
-		
-		double sum = std::accumulate(dists.begin(), dists.end(), 0.0);
-		double mean = sum / dists.size();
-		
-		PRINT_INFO("Mean Dz = " << mean);
-
-		std::vector<double> diff(dists.size());
-		std::transform(
-			dists.begin(), dists.end(), diff.begin(),
-			[&mean](double x) { return x - mean; }
-		);
-		double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-		double stdev = std::sqrt(sq_sum / dists.size());
-		
-		PRINT_INFO("Stdev Dz = " << stdev);
+	
+	const auto& paths = config.path.extrinsics;
+	PRINT_WARN("Evaluating " << paths.size() << " poses files");
+	
+	std::vector<DisplacementStats> stats(paths.size());
+	
+	std::atomic<std::size_t> next{0};
+	std::vector<std::thread> workers;
+	for (std::size_t t = 0; t < std::min(config.threads, paths.size()); ++t)
+	{
+		workers.emplace_back([&]() {
+			for (std::size_t i = next++; i < paths.size(); i = next++)
+			{
+				stats[i] = evaluate_displacements(paths[i], load_z(paths[i]), dz_gt, not config.percentiles.empty());
+			}
+		});
+	}
+	for (auto& w : workers) w.join();
+	
+	for (auto& s : stats) print(s, config.percentiles);
+	
+	if (config.path.output != "")
+	{
+		PRINT_WARN("Saving summary in " << config.path.output);
+		save(config.path.output, stats, config.percentiles);
 	}
 
 	PRINT_INFO("========= EOF =========");
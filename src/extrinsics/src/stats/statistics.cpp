@@ -0,0 +1,132 @@
+#include "statistics.h"
+
+//STD
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+//BOOST
+#include <boost/filesystem.hpp>
+
+#include <pleno/io/printer.h>
+
+void RunningStats::add(double x)
+{
+	++n_;
+	const double delta = x - mean_;
+	mean_ += delta / n_;
+	m2_ += delta * (x - mean_);
+	
+	min_ = std::min(min_, x);
+	max_ = std::max(max_, x);
+	
+	if (keep_) samples_.emplace_back(x);
+}
+
+double RunningStats::stdev() const { return std::sqrt(variance()); }
+
+double RunningStats::percentile(double p)
+{
+	if (not keep_ or samples_.empty()) return std::numeric_limits<double>::quiet_NaN();
+	
+	const double pos = std::clamp(p, 0., 100.) / 100. * (samples_.size() - 1);
+	const std::size_t lo = std::size_t(std::floor(pos));
+	const std::size_t hi = std::min(lo + 1, samples_.size() - 1);
+	
+	std::nth_element(samples_.begin(), samples_.begin() + lo, samples_.end());
+	const double vlo = samples_[lo];
+	if (hi == lo) return vlo;
+	
+	const double vhi = *std::min_element(samples_.begin() + hi, samples_.end());
+	return vlo + (pos - lo) * (vhi - vlo);
+}
+
+DisplacementStats evaluate_displacements(
+	const std::string& name, const std::vector<double>& z, double dz_gt, bool percentiles
+)
+{
+	DisplacementStats stats{name, RunningStats{percentiles}, RunningStats{percentiles}};
+	
+	for (std::size_t i = 1; i < z.size(); ++i)
+	{
+		const double dz = std::fabs(z[i - 1] - z[i]);
+		stats.absolute.add(dz);
+		stats.relative.add(100. * std::fabs(dz_gt - dz) / dz_gt);
+	}
+	
+	return stats;
+}
+
+void print(DisplacementStats& stats, const std::vector<double>& percentiles)
+{
+	auto print_ = [&percentiles](const std::string& label, RunningStats& rs, const std::string& unit) {
+		std::ostringstream oss;
+		oss << label << ": mean = " << rs.mean() << unit << ", stdev = " << rs.stdev() << unit
+			<< ", min = " << rs.min() << unit << ", max = " << rs.max() << unit;
+		for (const double p : percentiles) oss << ", p" << p << " = " << rs.percentile(p) << unit;
+		PRINT_INFO(oss.str());
+	};
+	
+	PRINT_INFO("=== " << stats.name << " (" << stats.absolute.size() << " displacements)");
+	print_("Absolute Dz", stats.absolute, " mm");
+	print_("Relative Dz", stats.relative, "%");
+}
+
+void save(const std::string& path, std::vector<DisplacementStats>& stats, const std::vector<double>& percentiles)
+{
+	const bool json = boost::filesystem::path(path).extension() == ".json";
+	
+	std::ofstream ofs(path);
+	
+	const std::vector<std::pair<std::string, RunningStats DisplacementStats::*>> blocks = {
+		{"abs", &DisplacementStats::absolute}, {"rel", &DisplacementStats::relative}
+	};
+	
+	//json has no representation of nan/inf
+	auto num = [json](double x) -> std::string {
+		if (json and not std::isfinite(x)) return "null";
+		std::ostringstream oss; oss.precision(12); oss << x;
+		return oss.str();
+	};
+	
+	if (json) ofs << "[\n";
+	else
+	{
+		ofs << "file,n";
+		for (const auto& [label, _] : blocks)
+		{
+			ofs << "," << label << "_mean," << label << "_stdev," << label << "_min," << label << "_max";
+			for (const double p : percentiles) ofs << "," << label << "_p" << p;
+		}
+		ofs << "\n";
+	}
+	
+	for (std::size_t i = 0; i < stats.size(); ++i)
+	{
+		auto& s = stats[i];
+		if (json) ofs << "\t{\"file\": \"" << s.name << "\", \"n\": " << s.absolute.size();
+		else ofs << s.name << "," << s.absolute.size();
+		
+		for (const auto& [label, member] : blocks)
+		{
+			RunningStats& rs = s.*member;
+			if (json)
+			{
+				ofs << ", \"" << label << "\": {\"mean\": " << num(rs.mean()) << ", \"stdev\": " << num(rs.stdev())
+					<< ", \"min\": " << num(rs.min()) << ", \"max\": " << num(rs.max());
+				for (const double p : percentiles) ofs << ", \"p" << p << "\": " << num(rs.percentile(p));
+				ofs << "}";
+			}
+			else
+			{
+				ofs << "," << num(rs.mean()) << "," << num(rs.stdev()) << "," << num(rs.min()) << "," << num(rs.max());
+				for (const double p : percentiles) ofs << "," << num(rs.percentile(p));
+			}
+		}
+		
+		if (json) ofs << "}" << (i + 1 < stats.size() ? ",\n" : "\n");
+		else ofs << "\n";
+	}
+	
+	if (json) ofs << "]\n";
+}
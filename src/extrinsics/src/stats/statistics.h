@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <limits>
+
+//Single-pass mean/variance (Welford), min/max, and exact percentiles when samples are kept
+class RunningStats {
+	std::size_t n_ = 0;
+	double mean_ = 0.;
+	double m2_ = 0.;
+	double min_ = std::numeric_limits<double>::max();
+	double max_ = std::numeric_limits<double>::lowest();
+	
+	bool keep_ = false;
+	std::vector<double> samples_;
+	
+public:
+	explicit RunningStats(bool keep = false) : keep_{keep} {}
+	
+	void add(double x);
+	
+	std::size_t size() const { return n_; }
+	double mean() const { return mean_; }
+	double variance() const { return (n_ > 0) ? m2_ / n_ : 0.; } //population variance, as before
+	double stdev() const;
+	double min() const { return min_; }
+	double max() const { return max_; }
+	
+	//Exact percentile p in [0,100] (linear interpolation), NaN if samples are not kept
+	double percentile(double p);
+};
+
+//Statistics of the displacements between consecutive positions along z
+struct DisplacementStats {
+	std::string name;
+	RunningStats absolute; //|dz| (mm)
+	RunningStats relative; //100 * |dz_gt - |dz|| / dz_gt (%)
+};
+
+//Positions must be sorted by frame
+DisplacementStats evaluate_displacements(
+	const std::string& name, const std::vector<double>& z, double dz_gt, bool percentiles
+);
+
+void print(DisplacementStats& stats, const std::vector<double>& percentiles);
+
+//Save a summary as csv or json (according to the extension)
+void save(const std::string& path, std::vector<DisplacementStats>& stats, const std::vector<double>& percentiles);
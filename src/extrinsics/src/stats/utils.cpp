@@ -1,5 +1,10 @@
 #include "utils.h"
 
+#include <thread>
+#include <regex>
+#include <sstream>
+#include <algorithm>
+
 // Boost
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
@@ -7,6 +12,39 @@
 #include <pleno/io/printer.h>
 
 
+//Expand a glob pattern (wildcards * and ? in the filename only), sorted by name
+static std::vector<std::string> expand(const std::string& pattern)
+{
+	namespace fs = boost::filesystem;
+	
+	const fs::path p{pattern};
+	const std::string name = p.filename().string();
+	if (name.find_first_of("*?") == std::string::npos) return {pattern};
+	
+	std::string re;
+	for (char c : name)
+	{
+		if (c == '*') re += ".*";
+		else if (c == '?') re += ".";
+		else if (std::string{".^$+()[]{}|\\"}.find(c) != std::string::npos) { re += '\\'; re += c; }
+		else re += c;
+	}
+	const std::regex regex{re};
+	
+	const fs::path dir = p.has_parent_path() ? p.parent_path() : fs::path{"."};
+	
+	std::vector<std::string> paths;
+	boost::system::error_code ec;
+	for (const auto& entry : fs::directory_iterator(dir, ec))
+	{
+		if (fs::is_regular_file(entry.status()) and std::regex_match(entry.path().filename().string(), regex))
+			paths.emplace_back(entry.path().string());
+	}
+	std::sort(paths.begin(), paths.end());
+	
+	return paths;
+}
+
 Config_t parse_args(int argc, char *argv[])
 {
 	namespace po = boost::program_options;
@@ -29,13 +67,32 @@ Config_t parse_args(int argc, char *argv[])
 			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
 		)
 		("extrinsics,e",
+			po::value<std::vector<std::string>>()->multitoken(),
+			"Paths (or glob patterns) to extrinsics parameters files"
+		)
+		("gt",
+			po::value<double>()->default_value(0.),
+			"Ground truth displacement between consecutive poses (mm), asked if not given"
+		)
+		("percentiles",
+			po::value<std::string>()->default_value(""),
+			"Comma-separated list of percentiles to compute exactly (e.g., 50,90,99)"
+		)
+		("threads,j",
+			po::value<std::size_t>()->default_value(std::max(1u, std::thread::hardware_concurrency())),
+			"Number of files evaluated concurrently"
+		)
+		("output,o",
 			po::value<std::string>()->default_value(""),
-			"Path to extrinsics parameters file"
+			"Path to save the summary (.csv or .json), not saved if empty"
 		);
+	
+	po::positional_options_description positional;
+	positional.add("extrinsics", -1);
 
 	po::variables_map vm;
 	try {
-		po::store(po::parse_command_line(argc, argv, desc), vm);
+		po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
 	}
 	catch (po::error &e) {
 		/* Invalid options */
@@ -56,7 +113,7 @@ Config_t parse_args(int argc, char *argv[])
 	}
 	
 	//check mandatory parameters
-	if(	vm["extrinsics"].as<std::string>() == "" )
+	if(	vm.count("extrinsics") == 0 )
 	{
 		/* print usage */
 		std::cerr << "Please specify at the configuration files. " << std::endl;
@@ -71,7 +128,21 @@ Config_t parse_args(int argc, char *argv[])
 	config.use_gui 	 		= vm["gui"].as<bool>();
 	config.verbose			= vm["verbose"].as<bool>();
 	config.level			= vm["level"].as<std::uint16_t>();
-	config.path.extrinsics	= vm["extrinsics"].as<std::string>();
+	config.gt				= vm["gt"].as<double>();
+	config.threads			= std::max<std::size_t>(1, vm["threads"].as<std::size_t>());
+	config.path.output		= vm["output"].as<std::string>();
+	
+	for (const auto& pattern : vm["extrinsics"].as<std::vector<std::string>>())
+	{
+		const auto paths = expand(pattern);
+		config.path.extrinsics.insert(config.path.extrinsics.end(), paths.begin(), paths.end());
+	}
+	
+	std::istringstream iss(vm["percentiles"].as<std::string>());
+	for (std::string p; std::getline(iss, p, ',');)
+	{
+		if (p != "") config.percentiles.emplace_back(std::stod(p));
+	}
 	
 	return config; 
 }
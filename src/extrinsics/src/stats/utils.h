@@ -2,14 +2,20 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 struct Config_t {
 	bool use_gui;
 	bool verbose;
 	std::uint16_t level;
 	
+	double gt; //ground truth displacement (mm), asked on stdin if not given
+	std::vector<double> percentiles;
+	std::size_t threads;
+	
 	struct {
-		std::string extrinsics;
+		std::vector<std::string> extrinsics; //glob patterns are expanded
+		std::string output;
 	} path;
 };
 
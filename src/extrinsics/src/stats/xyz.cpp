@@ -0,0 +1,88 @@
+#include "xyz.h"
+
+//STD
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+//POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <pleno/io/printer.h>
+
+XYZFile::XYZFile(const std::string& path)
+{
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) { PRINT_ERR("Can not open file = " << path); return; }
+	
+	struct stat st;
+	if (::fstat(fd, &st) == 0 and st.st_size > 0)
+	{
+		void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr != MAP_FAILED)
+		{
+			data_ = static_cast<const char*>(addr);
+			size_ = st.st_size;
+			::madvise(addr, size_, MADV_SEQUENTIAL);
+		}
+	}
+	::close(fd);
+	
+	if (not is_open()) { PRINT_ERR("Can not map file = " << path); return; }
+	
+	//header: number of points
+	const char* end = data_ + size_;
+	const char* it = data_;
+	while (it < end and (*it == ' ' or *it == '\t' or *it == '\r' or *it == '\n')) ++it;
+	
+	double count = 0.;
+	const char* p = parse(it, end, count);
+	count_ = (p and count > 0.) ? std::size_t(count) : 0;
+	
+	it = (p ? p : it);
+	while (it < end and *it != '\n') ++it;
+	points_ = it;
+}
+
+XYZFile::~XYZFile()
+{
+	if (data_) ::munmap(const_cast<char*>(data_), size_);
+}
+
+const char* XYZFile::parse(const char* first, const char* last, double& value)
+{
+#if defined(__cpp_lib_to_chars) 
+	const auto [ptr, ec] = std::from_chars(first, last, value);
+	return (ec == std::errc{}) ? ptr : nullptr;
+#else //no floating-point from_chars (gcc < 11): copy the token for strtod
+	char buf[64];
+	std::size_t n = 0;
+	while (first + n < last and n < sizeof(buf) - 1 and not std::strchr(" \t\r\n", first[n])) ++n;
+	std::memcpy(buf, first, n); buf[n] = '\0';
+	
+	char* end = nullptr;
+	value = std::strtod(buf, &end);
+	return (end != buf) ? first + (end - buf) : nullptr;
+#endif
+}
+
+double median_z(const std::string& path)
+{
+	const XYZFile file{path};
+	if (not file.is_open() or file.count() == 0) return std::numeric_limits<double>::quiet_NaN();
+	
+	std::vector<double> zs; zs.reserve(file.count());
+	const std::size_t n = file.for_each_z([&zs](double z) { zs.emplace_back(z); });
+	if (n == 0) return std::numeric_limits<double>::quiet_NaN();
+	
+	if (n != file.count()) PRINT_ERR("Read " << n << " points out of " << file.count() << " in file = " << path);
+	
+	const auto median = zs.begin() + n / 2;
+	std::nth_element(zs.begin(), median, zs.end());
+	return *median;
+}
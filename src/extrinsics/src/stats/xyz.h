@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+//Read-only memory mapping of a Raytrix point cloud (.xyz): 
+//the number of points on the first line, then one "x y z" point per line.
+class XYZFile {
+	const char* data_ = nullptr;
+	std::size_t size_ = 0;
+	std::size_t count_ = 0;
+	const char* points_ = nullptr; //first point
+	
+public:
+	explicit XYZFile(const std::string& path);
+	~XYZFile();
+	
+	XYZFile(const XYZFile&) = delete;
+	XYZFile& operator=(const XYZFile&) = delete;
+	
+	bool is_open() const { return data_ != nullptr; }
+	std::size_t count() const { return count_; }
+	
+	//Call f(z) for each point (at most count() points), return the number of points read
+	template<typename F> std::size_t for_each_z(F&& f) const;
+	
+private:
+	//Parse a double in [first, last), return the position after it or nullptr on failure
+	static const char* parse(const char* first, const char* last, double& value);
+};
+
+//Median (upper median for even sizes) of the depths of a point cloud, parsed in a single pass
+//over the mapped file keeping only z (8 bytes per point), then selected with nth_element.
+double median_z(const std::string& path);
+
+////////////////////////////////////////////////////////////////////////////////
+template<typename F> 
+std::size_t XYZFile::for_each_z(F&& f) const
+{
+	const char* it = points_;
+	const char* end = data_ + size_;
+	
+	auto is_space = [](char c) { return c == ' ' or c == '\t' or c == '\r' or c == '\n'; };
+	
+	std::size_t n = 0;
+	while (n < count_ and it < end)
+	{
+		while (it < end and is_space(*it)) ++it;
+		if (it >= end) break;
+		
+		double x, y, z;
+		const char* p = parse(it, end, x);
+		if (p) { while (p < end and (*p == ' ' or *p == '\t')) ++p; p = parse(p, end, y); }
+		if (p) { while (p < end and (*p == ' ' or *p == '\t')) ++p; p = parse(p, end, z); }
+		
+		//skip the rest of the line
+		it = (p ? p : it);
+		while (it < end and *it != '\n') ++it;
+		
+		if (not p) continue; //malformed line
+		
+		f(z);
+		++n;
+	}
+	
+	return n;
+}
@@ -28,6 +28,10 @@ Config_t parse_args(int argc, char *argv[])
 			"Select level of output to print (can be combined):\n"
 			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
 		)
+		("async-log",
+			po::value<bool>()->default_value(false),
+			"Write output from a background thread, with timestamps and thread ids"
+		)
 		("pimages,i",
 			po::value<std::string>()->default_value(""),
 			"Path to images configuration file"
@@ -46,11 +50,24 @@ Config_t parse_args(int argc, char *argv[])
 		)
 		("features,f",
 			po::value<std::string>()->default_value(""),
-			"Path to observations file"
+			"Path to observations file, or comma-separated list of files (.csv features and/or centers)"
 		)
 		("extrinsics,e",
 			po::value<std::string>()->default_value("extrinsics.js"),
 			"Path to saved extrinsics parameters file"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
+		)
+		("budget",
+			po::value<double>()->default_value(0.),
+			"Wall-clock budget (s) of the extrinsics optimization, run on batches of frames: batches predicted to exceed it "
+			"are not started, and their frames have no pose; 0 for unlimited"
+		)
+		("telemetry",
+			po::value<std::string>()->default_value(""),
+			"Stream convergence telemetry of the optimizations (JSONL) to a file or to a listening unix socket (unix:<path>), disabled if empty"
 		);
 
 	po::variables_map vm;
@@ -95,12 +112,16 @@ Config_t parse_args(int argc, char *argv[])
 	config.use_gui 	 		= vm["gui"].as<bool>();
 	config.verbose			= vm["verbose"].as<bool>();
 	config.level			= vm["level"].as<std::uint16_t>();
+	config.async_log		= vm["async-log"].as<bool>();
+	config.budget			= vm["budget"].as<double>();
 	config.path.images 		= vm["pimages"].as<std::string>();
 	config.path.camera 		= vm["pcamera"].as<std::string>();
 	config.path.params 		= vm["pparams"].as<std::string>();
 	config.path.scene 		= vm["pscene"].as<std::string>();
 	config.path.features	= vm["features"].as<std::string>();
 	config.path.extrinsics	= vm["extrinsics"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
+	config.path.telemetry	= vm["telemetry"].as<std::string>();
 	
 	return config; 
 }
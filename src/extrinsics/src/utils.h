@@ -7,6 +7,8 @@ struct Config_t {
 	bool use_gui;
 	bool verbose;
 	std::uint16_t level;
+	bool async_log;
+	double budget; //wall-clock budget (s), 0 for unlimited
 	
 	struct {
 		std::string images;
@@ -15,6 +17,8 @@ struct Config_t {
 		std::string scene;
 		std::string features;
 		std::string extrinsics;
+		std::string trace;
+		std::string telemetry;
 	} path;
 };
 
@@ -21,6 +21,10 @@
 #include <pleno/io/cfg/scene.h>
 #include <pleno/io/cfg/poses.h>
 
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/snapshot.h>
+
 #include "utils.h"
 
 int main(int argc, char* argv[])
@@ -32,24 +36,24 @@ int main(int argc, char* argv[])
 	
 	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
 	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
 
 ////////////////////////////////////////////////////////////////////////////////
 // 1) Load Camera information configuration file
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("1) Load camera");
 	PRINT_WARN("1) Load Camera information from configuration file");
 	PlenopticCamera mfpc;
-	load(config.path.camera, mfpc);
-	
-	InternalParameters params;
-	v::load(config.path.params, v::make_serializable(&params));
-	mfpc.params() = params;
+	compote::snapshot::load(config.path.camera, config.path.params, mfpc);
 
 	PRINT_INFO("Camera = " << mfpc << std::endl);
-	PRINT_INFO("Internal Parameters = " << params << std::endl);
+	PRINT_INFO("Internal Parameters = " << mfpc.params() << std::endl);
 	
 ////////////////////////////////////////////////////////////////////////////////
 // 2) Load Camera information configuration file
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("2) Load scene");
 	PRINT_WARN("2) Load Scene information from configuration file");	
 	PRINT_WARN("\t2.1) Loading Scene Model");
 	SceneConfig cfg_scene;
@@ -82,18 +86,25 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 3) Starting Calibration of the  inverse distortions
 ////////////////////////////////////////////////////////////////////////////////	
+	TRACE_STEP("3) Inverse distortions calibration");
 	PRINT_WARN("4) Starting Calibration of the inverse distortions");
 	Distortions invdistortions;
-	calibration_inverseDistortions(invdistortions, mfpc, scene);
+	{
+		compote::trace::Scope scope{"calibration_inverseDistortions"};
+		scope.arg("checkerboards", scene.size());
+		calibration_inverseDistortions(invdistortions, mfpc, scene);
+	}
 	
 	if(save())
 	{
 		mfpc.main_lens_invdistortions() = invdistortions;
 		
+		TRACE_STEP("4) Save");
 		PRINT_WARN("... Saving Intrinsic Parameters");
 		save(config.path.output, mfpc);
 	}
 	
+	compote::trace::flush();
 	PRINT_INFO("========= EOF =========");
 
 	Viewer::wait();
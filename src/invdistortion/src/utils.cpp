@@ -47,6 +47,10 @@ Config_t parse_args(int argc, char *argv[])
 		("output,o",
 			po::value<std::string>()->default_value("intrinsics.js"),
 			"Path to save optimized parameters file"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
 		);
 
 	po::variables_map vm;
@@ -96,6 +100,7 @@ Config_t parse_args(int argc, char *argv[])
 	config.path.scene 		= vm["pscene"].as<std::string>();
 	config.path.extrinsics	= vm["extrinsics"].as<std::string>();
 	config.path.output 		= vm["output"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
 	
 	return config; 
 }
@@ -14,6 +14,7 @@ struct Config_t {
 		std::string scene;
 		std::string extrinsics;
 		std::string output;
+		std::string trace;
 	} path;
 };
 
@@ -0,0 +1,124 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+#include <pleno/processing/calibration/calibration.h>
+
+#include "compote/schedule.h"
+
+// Anytime optimizations: the libpleno solvers run to convergence, so a wall-clock budget is enforced
+// between solves. Each solve (a stage of the coarse-to-fine schedule, a batch of frames) is only
+// started if it is predicted to end within the budget, from the time per observation of the previous
+// ones, and the schedule stops when the cost reaches a plateau. The returned estimate is the one of the
+// last completed solve. A Watchdog bounds the budget strictly, e.g. to save the best-so-far estimate
+// and exit while a solve is still running.
+namespace compote {
+
+struct Budget {
+	using clock = std::chrono::steady_clock;
+
+	double seconds = 0.; //wall-clock budget from start, 0 for unlimited
+	double plateau = 0.; //stop when the relative decrease of the cost between two stages is below, 0 to disable
+	clock::time_point start = clock::now();
+
+	bool unlimited() const { return seconds <= 0.; }
+	double elapsed() const { return std::chrono::duration<double>(clock::now() - start).count(); }
+	double remaining() const;
+	bool expired() const { return not unlimited() and elapsed() >= seconds; }
+};
+
+enum class StopReason { Completed, Plateau, Budget };
+const char* to_string(StopReason reason);
+
+struct StageStats {
+	std::string name;
+	double fraction = 1.; //of the observations
+	std::size_t observations = 0;
+	double seconds = 0.;
+	double cost = 0.; //rmse over every observation after the stage (pixel)
+};
+
+struct AnytimeReport {
+	StopReason reason = StopReason::Completed;
+	std::vector<StageStats> stages; //completed
+	std::size_t skipped = 0; //stages not run
+	double seconds = 0.;
+	double cost = 0.; //of the returned estimate
+};
+
+//Report as json object
+void write_json(std::ostream& os, const AnytimeReport& report, const std::string& indent = "");
+void write_json(const std::string& path, const std::map<std::string, AnytimeReport>& reports);
+
+//Called with the estimate of each completed stage
+using StageCallback = std::function<void(const PlenopticCamera&, const CalibrationPoses&, const AnytimeReport&)>;
+
+//calibration_PlenopticCamera over the stages of the schedule (then every observation) within the budget;
+//the cost is the rmse of the BAP residuals of every observation. The stages of a previous run (e.g., from
+//a checkpoint) are not run again, the next one starts from mfpc and poses.
+AnytimeReport calibrate_anytime(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const Schedule& schedule,
+	const Budget& budget,
+	const StageCallback& on_stage = {},
+	const AnytimeReport& previous = {}
+);
+
+//calibration_MIA over the stages of the schedule (then every center) within the budget, stratified
+//over a sensor of the given size; the cost is the rmse of the centers wrt the MIA nodes
+AnytimeReport calibrate_mia_anytime(
+	MIA& mia,
+	const MICObservations& centers,
+	std::size_t width, std::size_t height,
+	const Schedule& schedule,
+	const Budget& budget
+);
+
+//calibration_ExtrinsicsPlenopticCamera on batches of frames (poses are independent given the camera)
+//within the budget; frames not processed have no pose. There is no plateau (frames are independent).
+AnytimeReport extrinsics_anytime(
+	CalibrationPoses& poses,
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures,
+	const Budget& budget,
+	std::size_t batch = 4 //frames per solve
+);
+
+//Run a callback from a background thread when the budget expires, unless destroyed before
+class Watchdog {
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	bool cancelled_ = false;
+	std::thread thread_;
+
+public:
+	Watchdog(const Budget& budget, std::function<void()> on_expiry);
+	~Watchdog();
+
+	Watchdog(const Watchdog&) = delete;
+	Watchdog& operator=(const Watchdog&) = delete;
+};
+
+} //namespace compote
@@ -0,0 +1,41 @@
+#pragma once
+
+//STD
+#include <string>
+#include <optional>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+
+#include "compote/anytime.h"
+#include "compote/snapshot.h"
+
+// Checkpoints of calibrate_anytime: the initial model, then after each stage the estimate (camera, internal
+// parameters, poses) and the progress of the schedule (stages completed with their statistics) are saved as
+// a snapshot, written aside then renamed so that a preempted run always finds a complete checkpoint.
+// A resumed run starts the next stage from the checkpointed estimate. libpleno's solvers do not expose
+// their inner state (damping, iterations), which is not saved: an interrupted stage restarts from its
+// beginning, so that checkpoints are only useful with several stages (see Schedule::anytime).
+namespace compote::checkpoint {
+
+struct State {
+	PlenopticCamera mfpc;
+	CalibrationPoses poses;
+	AnytimeReport report; //stages completed
+};
+
+//Progress of a run of the schedule on the given number of observations
+snapshot::Progress progress(const Schedule& schedule, std::size_t features, std::size_t centers, const AnytimeReport& report);
+
+void save(const std::string& path, const PlenopticCamera& mfpc, const CalibrationPoses& poses, const snapshot::Progress& progress);
+
+//Checkpoint of a run of the schedule on the given number of observations,
+//empty (with a warning) if there is none or it belongs to another run
+std::optional<State> load(const std::string& path, const Schedule& schedule, std::size_t features, std::size_t centers);
+
+//Stage callback of calibrate_anytime saving a checkpoint after each stage
+StageCallback writer(const std::string& path, const Schedule& schedule, std::size_t features, std::size_t centers);
+
+} //namespace compote::checkpoint
@@ -0,0 +1,89 @@
+#pragma once
+
+//STD
+#include <string>
+#include <utility>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/io/cfg/observations.h>
+
+// Compression codecs of the artifacts saved with v::save (observations, configurations):
+//   gzip (.gz)  : single-threaded, written and read by libpleno itself
+//   zstd (.zst) : multi-threaded compression, fast decompression, better ratio than gzip
+//   lz4  (.lz4) : concatenated frames compressed concurrently, fastest, lower ratio
+// The codec is selected by the extension of the saved file and detected from the magic number
+// of the read file, whatever its extension. zstd and lz4 are available when the library was
+// built with them (COMPOTE_WITH_ZSTD, COMPOTE_WITH_LZ4); the artifact is then serialized by
+// libpleno in a temporary uncompressed file in memory (/dev/shm, else the temporary directory), and
+// only the compressed bytes are streamed to (resp. from) the artifact path.
+namespace compote::codec {
+
+enum class Codec { None, Gzip, Zstd, LZ4 };
+
+struct Options {
+	int level = 0; //0 for the codec default
+	std::size_t threads = 0; //0 for hardware concurrency
+};
+
+const char* name(Codec codec);
+const char* extension(Codec codec); //"" for None
+bool available(Codec codec);
+
+//Codec from its name ("none", "gzip", "zstd", "lz4"), throw if unknown
+Codec parse(const std::string& name);
+//Codec from its name, falling back to gzip (with a warning) if it is not available
+Codec select(const std::string& name);
+//Codec from the name of a file, e.g. observations.bin.zst -> Zstd
+Codec from_extension(const std::string& path);
+//Codec from the first bytes of a file
+Codec detect(const std::string& path);
+
+//Path of an artifact with the extension of the codec, e.g. (observations.bin, Zstd) -> observations.bin.zst
+std::string path(const std::string& stem, Codec codec);
+
+//In-memory (de)compression, decompress detects the codec; throw on error or if the codec is not available
+std::string compress(const std::string& data, Codec codec, const Options& options = {});
+std::string decompress(const std::string& data);
+
+//File (de)compression, streamed
+void compress(const std::string& src, const std::string& dst, Codec codec, const Options& options = {});
+void decompress(const std::string& src, const std::string& dst);
+
+namespace detail {
+//Memory-backed directory of temporary files: /dev/shm if writable, else the temporary directory
+std::string scratch();
+//Temporary path of the uncompressed artifact in the scratch directory, keeping its inner extension (e.g., .bin, .js)
+std::string temporary(const std::string& path);
+void remove(const std::string& path);
+} //namespace detail
+
+//v::save through the codec given by the extension of path
+template<typename T>
+void save(const std::string& path, T&& cfg, const Options& options = {})
+{
+	const Codec codec = from_extension(path);
+	if (codec == Codec::None or codec == Codec::Gzip) { v::save(path, std::forward<T>(cfg)); return; }
+
+	const std::string tmp = detail::temporary(path);
+	v::save(tmp, std::forward<T>(cfg));
+	try { compress(tmp, path, codec, options); }
+	catch (...) { detail::remove(tmp); throw; }
+	detail::remove(tmp);
+}
+
+//v::load through the codec detected from the content of path
+template<typename T>
+void load(const std::string& path, T&& cfg)
+{
+	const Codec codec = detect(path);
+	if (codec == Codec::None or (codec == Codec::Gzip and from_extension(path) == Codec::Gzip)) { v::load(path, std::forward<T>(cfg)); return; }
+
+	const std::string tmp = detail::temporary(path);
+	try { decompress(path, tmp); v::load(tmp, std::forward<T>(cfg)); }
+	catch (...) { detail::remove(tmp); throw; }
+	detail::remove(tmp);
+}
+
+} //namespace compote::codec
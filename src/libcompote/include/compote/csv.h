@@ -0,0 +1,51 @@
+#pragma once
+
+//STD
+#include <string>
+
+#include "compote/observations.h"
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/observation.h>
+
+#include <pleno/io/cfg/observations.h>
+
+// Comma-separated observations, as exchanged with external tooling:
+//   features: k,l,u,v,rho,cluster,frame[,inlier]
+//   centers:  k,l,u,v
+// The optional inlier column (0 or 1) stores the inlier mask of the features (see compote/robust.h).
+// Columns are matched by name from the header (any order, extra columns are ignored), so that the
+// kind of a file is told by its header. Files are memory-mapped and split into newline-aligned
+// chunks parsed concurrently with from_chars; rows keep the file order. Rows are written with the
+// shortest representation that reads back to the same double, formatted concurrently in memory
+// and flushed with a single buffered write.
+namespace compote::csv {
+
+enum class Kind { Unknown, Features, Centers };
+
+bool is_csv(const std::string& path); //by extension
+
+//Kind of a csv file, from its header
+Kind kind(const std::string& path);
+
+//Read all rows, threads = 0 for hardware concurrency; throw if the file or its header can not be read,
+//malformed rows are skipped with a warning
+void read(const std::string& path, BAPObservations& observations, std::size_t threads = 0);
+void read(const std::string& path, MICObservations& observations, std::size_t threads = 0);
+//Features and their inlier mask (every feature is an inlier if the file has no inlier column)
+void read(const std::string& path, BAPObservations& observations, Mask& inliers, std::size_t threads = 0);
+
+//Write all rows with a header; throw if the file can not be written
+void write(const std::string& path, const BAPObservations& observations, std::size_t threads = 0);
+void write(const std::string& path, const MICObservations& observations, std::size_t threads = 0);
+//Features with an inlier column
+void write(const std::string& path, const BAPObservations& observations, const Mask& inliers, std::size_t threads = 0);
+
+//Load observations from a comma-separated list of files, each one being either a csv (features or
+//centers, told by its header) or an ObservationsConfig (e.g., .bin.gz), e.g. "bap.csv,center.csv";
+//features of a csv with an inlier column are only loaded if they are inliers
+void load(const std::string& paths, ObservationsConfig& cfg, std::size_t threads = 0);
+
+} //namespace compote::csv
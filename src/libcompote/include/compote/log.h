@@ -0,0 +1,52 @@
+#pragma once
+
+//STD
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <iosfwd>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+// Asynchronous logging backend: once started, std::cout and std::cerr (hence libpleno's PRINT_* 
+// and DEBUG_VAR) are redirected to per-thread line buffers. Complete lines are pushed in a 
+// lock-free queue, and a background writer prefixes them with a timestamp and the thread id and
+// writes them to the original streams. Flushing a stream submits the partial line of the calling
+// thread, and reading std::cin first drains the pending lines (partial ones included), so that
+// prompts are displayed before waiting for an answer. A Capture sends the lines of a thread to a
+// file instead, e.g. the log of a job run by a worker thread of the service.
+namespace compote::log {
+
+void start();
+//Write the pending lines and restore the original streams (also done at exit)
+void stop();
+//Wait until every line submitted so far, and the partial lines of the calling thread, are written
+void flush();
+
+//While alive, the lines written by the calling thread (the log being started) are written to a file
+//instead of the original streams; lines of other threads (e.g., spawned by OpenCV) are not captured
+class Capture {
+	std::shared_ptr<std::ostream> previous_;
+	
+public:
+	explicit Capture(const std::string& path); //throw if the file can not be opened
+	~Capture();
+	
+	Capture(const Capture&) = delete;
+	Capture& operator=(const Capture&) = delete;
+};
+
+//Is the level enabled in the printer
+inline bool enabled(std::uint16_t level) { return (Printer::level() & level) != 0; }
+
+} //namespace compote::log
+
+// Same as libpleno's macros, but the arguments are not evaluated when the level is disabled
+#define LOG_IF(level, ...) do { if (compote::log::enabled(level)) { __VA_ARGS__; } } while (0)
+
+#define LOG_ERR(msg) LOG_IF(Printer::Level::ERR, PRINT_ERR(msg))
+#define LOG_WARN(msg) LOG_IF(Printer::Level::WARN, PRINT_WARN(msg))
+#define LOG_INFO(msg) LOG_IF(Printer::Level::INFO, PRINT_INFO(msg))
+#define LOG_DEBUG(msg) LOG_IF(Printer::Level::DEBUG, PRINT_DEBUG(msg))
+#define LOG_VAR(var) LOG_IF(Printer::Level::DEBUG, DEBUG_VAR(var))
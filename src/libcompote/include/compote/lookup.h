@@ -0,0 +1,76 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+
+namespace compote {
+
+struct Owner {
+	int k = -1, l = -1; //micro-image, -1 if none
+	int type = -1; //focal type
+	bool inside = false; //within the micro-image disk
+	
+	bool valid() const { return k >= 0; }
+};
+
+// Label image of the sensor: each pixel holds the micro-image (k,l) whose center is the closest
+// and whether it lies inside its disk, so that ownership queries are O(1) instead of being
+// recomputed from the MIA mesh pose and pitch. It is built once from a calibrated MIA and saved 
+// run-length encoded next to the internal parameters (e.g., params.js -> params.mimap).
+class MicroImageMap {
+	static constexpr std::uint32_t none = 0xffffffffu;
+	static constexpr std::uint32_t inside_bit = 0x80000000u;
+	
+	std::size_t cols_ = 0, rows_ = 0; //sensor
+	std::size_t width_ = 0, height_ = 0; //MIA
+	std::size_t I_ = 0;
+	
+	std::vector<std::uint32_t> labels_; //l * width + k, with inside_bit, or none
+	std::vector<std::uint8_t> types_;
+	std::vector<double> signature_; //MIA geometry the map was built from
+	
+public:
+	MicroImageMap() = default;
+	MicroImageMap(const MIA& mia, std::size_t I, std::size_t cols, std::size_t rows);
+	
+	std::size_t cols() const { return cols_; }
+	std::size_t rows() const { return rows_; }
+	bool empty() const { return labels_.empty(); }
+	
+	Owner operator()(int u, int v) const
+	{
+		if (u < 0 or v < 0 or std::size_t(u) >= cols_ or std::size_t(v) >= rows_) return {};
+		
+		const std::uint32_t label = labels_[std::size_t(v) * cols_ + u];
+		if (label == none) return {};
+		
+		const std::uint32_t i = label & ~inside_bit;
+		return {int(i % width_), int(i / width_), types_[i], (label & inside_bit) != 0};
+	}
+	Owner operator()(const P2D& p) const { return (*this)(int(std::lround(p[0])), int(std::lround(p[1]))); }
+	
+	//Bulk queries
+	void lookup(const std::vector<P2D>& points, std::vector<Owner>& owners) const;
+	
+	//Set (k,l) of observations from their (u,v)
+	void attach(MICObservations& observations) const;
+	void attach(BAPObservations& observations) const;
+	
+	//Does the map correspond to this MIA and sensor
+	bool matches(const MIA& mia, std::size_t I, std::size_t cols, std::size_t rows) const;
+	
+	void save(const std::string& path) const;
+	bool load(const std::string& path); //false if the file does not exist or is invalid
+	
+	//Path of the map stored next to the internal parameters
+	static std::string path_for(const std::string& params);
+};
+
+} //namespace compote
@@ -0,0 +1,112 @@
+#pragma once
+
+//STD
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+namespace compote {
+
+//Inlier mask of observations, 1 if the observation is an inlier
+using Mask = std::vector<std::uint8_t>;
+
+//Contiguous range of observations
+template<typename T>
+struct Range {
+	const T* first = nullptr;
+	const T* last = nullptr;
+	
+	const T* begin() const { return first; }
+	const T* end() const { return last; }
+	std::size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+	const T& operator[](std::size_t i) const { return first[i]; }
+};
+
+//Observations given by their indices in a contiguous storage
+template<typename T>
+struct IndexedRange {
+	const T* data = nullptr;
+	const std::uint32_t* first = nullptr;
+	const std::uint32_t* last = nullptr;
+	
+	struct iterator {
+		const T* data; const std::uint32_t* it;
+		const T& operator*() const { return data[*it]; }
+		const T* operator->() const { return data + *it; }
+		iterator& operator++() { ++it; return *this; }
+		bool operator!=(const iterator& other) const { return it != other.it; }
+		bool operator==(const iterator& other) const { return it == other.it; }
+	};
+	
+	iterator begin() const { return {data, first}; }
+	iterator end() const { return {data, last}; }
+	std::size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+	const T& operator[](std::size_t i) const { return data[first[i]]; }
+};
+
+// BAP observations sorted by frame, then cluster, then (k,l), with CSR offset tables so that
+// observations of a frame, of a (frame, cluster), of a micro-lens or of a micro-lens type are
+// obtained in O(1), without scanning nor copying.
+class IndexedObservations {
+	BAPObservations observations_; //sorted
+	std::vector<std::uint32_t> sources_; //index of each sorted observation in the given ones
+	
+	int min_frame_ = 0;
+	std::vector<std::uint32_t> frame_offsets_; //frame - min_frame -> [offsets[f], offsets[f+1])
+	
+	std::vector<std::uint32_t> cluster_offsets_; //per frame: start in clusters_
+	std::vector<int> clusters_; //cluster id of each (frame, cluster) group
+	std::vector<std::uint32_t> group_offsets_; //(frame, cluster) group -> observations
+	
+	std::size_t lens_width_ = 0; //max k + 1
+	std::vector<std::uint32_t> lens_offsets_; //l * width + k -> lens_indices_
+	std::vector<std::uint32_t> lens_indices_;
+	
+	std::vector<std::uint32_t> type_offsets_; //type -> type_indices_
+	std::vector<std::uint32_t> type_indices_;
+	
+public:
+	using value_type = BAPObservation;
+	
+	IndexedObservations() = default;
+	explicit IndexedObservations(const BAPObservations& observations);
+	
+	//Micro-lens types of each observation, to query by type
+	void index_types(const MIA& mia, std::size_t I);
+	
+	const BAPObservations& observations() const { return observations_; }
+	//Index in the observations given to the constructor of the i-th sorted observation
+	std::size_t source(std::size_t i) const { return sources_[i]; }
+	std::size_t size() const { return observations_.size(); }
+	Range<BAPObservation> all() const { return {observations_.data(), observations_.data() + observations_.size()}; }
+	
+	//Frames present, in increasing order
+	std::vector<int> frames() const;
+	
+	Range<BAPObservation> frame(int f) const;
+	Range<BAPObservation> frame_cluster(int f, int cluster) const;
+	IndexedRange<BAPObservation> lens(int k, int l) const;
+	IndexedRange<BAPObservation> type(int t) const;
+	
+	//Number of (frame, cluster) groups of a frame and the i-th one
+	std::size_t nb_clusters(int f) const;
+	Range<BAPObservation> cluster(int f, std::size_t i) const;
+	
+private:
+	Range<BAPObservation> range(std::uint32_t b, std::uint32_t e) const { return {observations_.data() + b, observations_.data() + e}; }
+	IndexedRange<BAPObservation> indexed(const std::vector<std::uint32_t>& idx, std::uint32_t b, std::uint32_t e) const 
+	{ 
+		return {observations_.data(), idx.data() + b, idx.data() + e}; 
+	}
+	bool has_frame(int f) const { return f >= min_frame_ and std::size_t(f - min_frame_) + 1 < frame_offsets_.size(); }
+};
+
+} //namespace compote
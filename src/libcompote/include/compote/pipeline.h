@@ -0,0 +1,155 @@
+#pragma once
+
+//STD
+#include <vector>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+#include <pleno/io/cfg/images.h>
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/images.h>
+
+#include <pleno/processing/calibration/calibration.h>
+
+#include "compote/schedule.h"
+
+namespace compote {
+
+//In-memory equivalent of an ImagesConfig
+struct Images {
+	std::vector<ImageWithInfo> whites;
+	std::vector<ImageWithInfo> checkerboards;
+	Image mask;
+	std::size_t format = 8; //8 or 16 bits
+};
+
+struct Options {
+	bool invdistortion = false; //calibrate inverse distortions after the main optimization
+	bool blur = false; //calibrate the blur proportionality coefficient (multifocus only)
+	Schedule schedule; //coarse-to-fine stages before the optimization on every observation
+};
+
+struct Calibration {
+	PlenopticCamera camera;
+	InternalParameters params;
+	CalibrationPoses poses;
+	
+	BAPObservations features;
+	MICObservations centers;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Loading
+////////////////////////////////////////////////////////////////////////////////
+//Decode the images referenced by a configuration (whites, checkerboards, mask)
+void load(const ImagesConfig& cfg, Images& images, bool whites = true, bool checkerboards = true);
+
+//Images of a configuration decoded on first access, so that stages reusing existing 
+//artifacts (params, features) do not pay for decoding images they do not consume
+class LazyImages {
+	ImagesConfig cfg_;
+	bool available_ = false;
+	Images images_;
+	bool whites_ = false, checkerboards_ = false; //decoded
+	
+public:
+	LazyImages() = default;
+	explicit LazyImages(const ImagesConfig& cfg);
+	
+	bool available() const { return available_; }
+	std::size_t format() const { return available_ ? cfg_.meta().format() : 8u; }
+	
+	const std::vector<ImageWithInfo>& whites();
+	const std::vector<ImageWithInfo>& checkerboards();
+	const Image& mask(); //decoded with the checkerboards
+	
+	//Images decoded so far
+	const Images& images() const { return images_; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Stages
+////////////////////////////////////////////////////////////////////////////////
+//Calibrate the MIA geometry from white images and compute the internal parameters, as the precalibrate
+//app does: white images with overlapping micro-images (f-number up to the main-lens aperture, except for
+//unfocused cameras) are skipped and the centers are detected knowing the number of micro-lens types.
+//The calibrate app keeps its own fixed rule (f/4 and above, single type), so its MIA may differ slightly.
+InternalParameters precalibrate(
+	MIA& mia, 
+	const std::vector<ImageWithInfo>& whites, 
+	const PlenopticCameraConfig& cfg_camera
+);
+
+//Devignette a raw checkerboard image using the mask
+Image devignette(const Image& img, const Image& mask, std::size_t format);
+
+//Detect BAP features in every checkerboard image, frame index is taken from the image or its rank
+BAPObservations detect_features(
+	const Images& images, 
+	const MIA& mia, 
+	const InternalParameters& params
+);
+
+//Detect micro-image centers in a white image
+MICObservations detect_centers(const Image& white, std::size_t I);
+
+//Devignetted grayscale images indexed by frame (or rank, as detect_features), as used by the blur-aware cost functions
+IndexedImages pictures(const Images& images);
+
+//Initial camera model from configuration, calibrated MIA and internal parameters
+PlenopticCamera initial_camera(
+	const PlenopticCameraConfig& cfg_camera, 
+	const MIA& mia, 
+	const InternalParameters& params
+);
+
+//Calibrate intrinsics and poses, then optionally inverse distortions and blur coefficient
+void calibrate(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const Options& options = {}
+);
+
+//Inverse distortions and blur coefficient, as enabled in the options, given calibrated intrinsics and poses
+void postcalibrate(
+	const CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures,
+	const Options& options
+);
+
+//Estimate poses given a calibrated camera
+void extrinsics(
+	CalibrationPoses& poses,
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures
+);
+
+////////////////////////////////////////////////////////////////////////////////
+// Whole flow: precalibrate -> detect -> calibrate
+////////////////////////////////////////////////////////////////////////////////
+//Run every stage whose result is not given: mia and params are pre-calibrated if no params are given, 
+//features (resp. centers) are detected if none are given.
+Calibration calibrate(
+	const Images& images,
+	const PlenopticCameraConfig& cfg_camera,
+	const CheckerBoard& scene,
+	const InternalParameters* params = nullptr,
+	const BAPObservations* features = nullptr,
+	const MICObservations* centers = nullptr,
+	const Options& options = {}
+);
+
+} //namespace compote
@@ -0,0 +1,64 @@
+#pragma once
+
+//STD
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace compote {
+
+//Bounded multi-producer/single-consumer queue (Vyukov): each cell carries a sequence number
+//telling whether it is free for the producer of a given position or ready for the consumer
+template<typename T, std::size_t N>
+class Queue {
+	static_assert((N & (N - 1)) == 0, "capacity must be a power of two");
+	
+	struct Cell {
+		std::atomic<std::size_t> seq;
+		T value;
+	};
+	
+	Cell cells_[N];
+	alignas(64) std::atomic<std::size_t> head_{0}; //producers
+	alignas(64) std::size_t tail_ = 0; //consumer
+	
+public:
+	Queue() { for (std::size_t i = 0; i < N; ++i) cells_[i].seq.store(i, std::memory_order_relaxed); }
+	
+	bool push(T&& value)
+	{
+		std::size_t pos = head_.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& cell = cells_[pos & (N - 1)];
+			const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+			const std::intptr_t diff = std::intptr_t(seq) - std::intptr_t(pos);
+			
+			if (diff == 0)
+			{
+				if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.value = std::move(value);
+					cell.seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) return false; //full
+			else pos = head_.load(std::memory_order_relaxed);
+		}
+	}
+	
+	bool pop(T& value)
+	{
+		Cell& cell = cells_[tail_ & (N - 1)];
+		if (cell.seq.load(std::memory_order_acquire) != tail_ + 1) return false; //empty
+		
+		value = std::move(cell.value);
+		cell.seq.store(tail_ + N, std::memory_order_release);
+		++tail_;
+		return true;
+	}
+};
+
+} //namespace compote
@@ -0,0 +1,42 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+// Debug overlays (a background image and a batch of points). Headless, overlays are pushed in a
+// lock-free queue bounded in slots and in bytes (256 MB of pending images) and written as PNG files
+// by a dedicated thread, off the computation thread. The viewer is not thread-safe and is also drawn
+// by libpleno and the applications, so in viewer mode overlays are drawn by the submitting thread,
+// the points being rasterized on the background so that each overlay is a single viewer primitive.
+// Submitting is a no-op when rendering is off.
+namespace compote::render {
+
+enum class Mode : std::uint8_t { Off = 0, Viewer, Headless };
+
+enum class Color : std::uint8_t { Blue = 0, Green, Purple };
+
+struct Overlay {
+	std::string name;
+	Image image; //background, may be empty
+	std::vector<P2D> points; //drawn as one batch
+	Color color = Color::Blue;
+	int width = 5;
+};
+
+//Start rendering (and the render thread in headless mode), overlays are written in directory in headless mode
+void start(Mode mode, const std::string& directory = "");
+//Write the pending overlays and stop the render thread
+void stop();
+
+Mode mode();
+inline bool enabled() { return mode() != Mode::Off; }
+
+//Headless: non-blocking, the overlay is dropped (and counted) if the queue is full or over its bytes; viewer: drawn now
+void submit(Overlay&& overlay);
+
+} //namespace compote::render
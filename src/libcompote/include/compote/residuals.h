@@ -0,0 +1,88 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+#include <map>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+namespace compote {
+
+//Reprojection residuals of a set of observations, stored by column
+struct Residuals {
+	std::vector<int> index; //of the observation
+	std::vector<int> frame;
+	std::vector<int> k, l;
+	std::vector<int> type; //micro-lens type
+	std::vector<int> zone; //radial zone on the sensor
+	std::vector<double> u, v; //observation
+	std::vector<double> du, dv, drho; //predicted - observed (drho = 0 for centers)
+	
+	std::size_t invalid = 0; //observations that could not be reprojected
+	
+	std::size_t size() const { return frame.size(); }
+	void resize(std::size_t n);
+};
+
+struct ResidualsOptions {
+	std::size_t threads = 0; //0 = hardware concurrency
+	std::size_t zones = 5; //number of radial zones, from the sensor center to its corners
+	std::size_t bins = 40; //histogram bins of the reprojection error norm
+	double max = 2.; //histogram range (pixel, > 0), larger errors go to the last bin
+};
+
+//BAP residuals (u,v,rho) of observations whose frame has a pose; the corners are transformed to the
+//camera frame once per (frame, corner), the projection is run per observation (analytics only)
+Residuals bap_residuals(
+	const PlenopticCamera& mfpc, 
+	const CheckerBoard& scene, 
+	const CalibrationPoses& poses, 
+	const BAPObservations& observations,
+	const ResidualsOptions& options = {}
+);
+
+//Residuals of micro-image centers wrt the calibrated MIA
+Residuals center_residuals(
+	const PlenopticCamera& mfpc, 
+	const MICObservations& observations,
+	const ResidualsOptions& options = {}
+);
+
+//Statistics of the reprojection error norm (and of rho error) of a group of residuals
+struct ErrorStats {
+	std::size_t n = 0;
+	double sum = 0., sumsq = 0., max = 0.; //error norm in (u,v)
+	double sumsq_rho = 0.;
+	std::vector<std::size_t> histogram;
+	
+	void add(double e, double erho, const ResidualsOptions& options); //non-finite errors are ignored
+	void merge(const ErrorStats& other);
+	
+	double mean() const { return (n > 0) ? sum / n : 0.; }
+	double rmse() const;
+	double rmse_rho() const;
+};
+
+struct ResidualsReport {
+	ErrorStats all;
+	std::map<int, ErrorStats> frames;
+	std::map<int, ErrorStats> types;
+	std::map<int, ErrorStats> zones;
+	std::size_t invalid = 0;
+};
+
+ResidualsReport aggregate(const Residuals& residuals, const ResidualsOptions& options = {});
+
+//Report as json object
+void write_json(std::ostream& os, const ResidualsReport& report, const ResidualsOptions& options, const std::string& indent = "");
+
+//Columnar dump: one raw little-endian array per column (<column>.i32 or <column>.f64) 
+//and a schema (columns.json), e.g. numpy.fromfile(path + "/du.f64")
+void save_columns(const std::string& directory, const Residuals& residuals);
+
+} //namespace compote
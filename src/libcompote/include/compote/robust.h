@@ -0,0 +1,101 @@
+#pragma once
+
+//STD
+#include <string>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+#include <pleno/processing/calibration/calibration.h>
+
+#include "compote/observations.h"
+#include "compote/residuals.h"
+#include "compote/anytime.h"
+
+// Robust estimation on BAP observations. Bad detections (mis-linked corners, saturated micro-images)
+// are flagged by a pre-pass on the residuals of each frame: a feature is an outlier when its error
+// exceeds the median error of its frame by more than threshold robust standard deviations (1.4826 MAD).
+// The main solve may then use a robust loss by IRLS: libpleno's solvers minimize plain least squares,
+// so each reweighting round solves on pseudo-observations moved towards their prediction,
+// o* = p + w(|e|) (o - p), where w is the IRLS weight of the loss (Huber's pseudo-observations).
+namespace compote {
+
+enum class Loss { Squared, Huber, Cauchy };
+
+const char* to_string(Loss loss);
+//Loss from its name ("squared", "huber", "cauchy"), throw if unknown
+Loss parse_loss(const std::string& name);
+
+//IRLS weight of an error e (pixel) for a loss of scale c
+double weight(Loss loss, double e, double c);
+
+struct RobustOptions {
+	double threshold = 0.; //outlier pre-pass threshold (robust standard deviations), 0 to disable
+	double fraction = 0.1; //of the features of each frame used to estimate the poses of the pre-pass
+	std::size_t min_frame = 10; //frames with fewer features are not filtered
+	
+	Loss loss = Loss::Squared;
+	double scale = 0.; //of the loss (pixel), 0 for the usual constant (Huber 1.345, Cauchy 2.385) times the robust standard deviation
+	std::size_t rounds = 2; //IRLS reweighting rounds
+	
+	ResidualsOptions residuals;
+};
+
+//Robust standard deviation of the errors (1.4826 MAD), 0 if empty
+double robust_sigma(std::vector<double> errors);
+
+//Inliers of the features given poses; features of frames without pose, of frames with fewer than
+//min_frame features, or that can not be reprojected are kept
+Mask flag_outliers(
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const CalibrationPoses& poses,
+	const BAPObservations& features,
+	const RobustOptions& options
+);
+
+//Pre-pass after initialization: poses estimated with calibration_ExtrinsicsPlenopticCamera on a
+//stratified fraction of the features (see decimate), then outliers flagged
+Mask prepass(
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures,
+	const RobustOptions& options
+);
+
+//Features of the mask
+BAPObservations select(const BAPObservations& features, const Mask& inliers);
+std::size_t count(const Mask& inliers);
+
+//Pseudo-observations of the features for the loss, features that can not be reprojected are kept as is
+BAPObservations pseudo_observations(
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const CalibrationPoses& poses,
+	const BAPObservations& features,
+	Loss loss, double scale,
+	const ResidualsOptions& options = {}
+);
+
+//IRLS rounds of calibration_PlenopticCamera from the current estimate (and poses), each one being a
+//full solve run after convergence. A round is only started if it is predicted to end within the budget,
+//from the time per observation of the previous solves (e.g., the report of calibrate_anytime) and rounds.
+//The report has a stage per round ("irls-<round>"), on_round is called with the estimate of each one.
+AnytimeReport irls(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const RobustOptions& options,
+	const Budget& budget = {},
+	const AnytimeReport& previous = {},
+	const StageCallback& on_round = {}
+);
+
+} //namespace compote
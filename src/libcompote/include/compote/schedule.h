@@ -0,0 +1,56 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+#include <pleno/processing/calibration/calibration.h>
+
+namespace compote {
+
+// Coarse-to-fine calibration: the first stages optimize on stratified subsets of the observations,
+// each stage starting from the camera and poses estimated by the previous one, so that the iterations run
+// while far from the optimum are cheap; the last stage always runs on every observation.
+struct Schedule {
+	std::vector<double> fractions; //increasing fractions of observations of the first stages, in (0,1)
+	std::size_t zones = 3; //radial zones of the sensor used for stratification
+
+	bool empty() const { return fractions.empty(); }
+	//Fractions of every stage, ending with 1 (every observation)
+	std::vector<double> stages() const;
+
+	//Fractions from a comma-separated list (e.g., "0.1,0.3"), values outside (0,1) are dropped
+	static Schedule parse(const std::string& fractions);
+	//Stages used when none are given but an estimate is needed before the solve on every observation
+	//(budget, plateau): 10% then 30% of the observations
+	static Schedule anytime();
+};
+
+// Subset of observations keeping a fraction of each stratum, rounded up so that no stratum is left
+// empty: strata are (frame, cluster, radial zone) for BAP features, (type, radial zone) for centers.
+// Observations are ranked by a hash of (frame, cluster, k, l) within their stratum, so that subsets
+// are nested (the subset of a fraction holds the subset of any smaller one) and reproducible.
+// Observations keep their relative order.
+BAPObservations decimate(const BAPObservations& observations, const PlenopticCamera& mfpc, double fraction, std::size_t zones = 3);
+MICObservations decimate(const MICObservations& observations, const PlenopticCamera& mfpc, double fraction, std::size_t zones = 3);
+//Zones of a sensor of the given size (pixel), e.g. when only the MIA is known
+MICObservations decimate(const MICObservations& observations, std::size_t width, std::size_t height, double fraction, std::size_t zones = 3);
+
+//calibration_PlenopticCamera run on each stage of the schedule, then on every observation
+void calibrate_coarse_to_fine(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const Schedule& schedule
+);
+
+} //namespace compote
@@ -0,0 +1,85 @@
+#pragma once
+
+//STD
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/poses.h>
+
+// Versioned binary snapshot of a calibration (camera, internal parameters, MIA, poses), 
+// loaded without parsing the decimal strings of the json configuration files.
+//
+// Layout (native byte order):
+//   "COMPOTE\x1a" | u32 version | u32 number of sections | sections
+//   section = u32 tag | u64 size | payload
+// Camera, internal parameters, MIA and poses payloads are libpleno's own binary archives of their
+// configuration (the bytes v::save writes in a .bin file), so that the schema follows libpleno's; 
+// the progress payload stores numbers with their binary representation, vectors as u64 size | elements.
+// Unknown sections are skipped, a version change means the section layout changed. libpleno only 
+// (de)serializes through files: archives go through a memory-backed scratch file (see compote/codec.h).
+// Files are written aside, synced then renamed, so that a reader never sees a partial snapshot,
+// even after a crash of the system.
+namespace compote::snapshot {
+
+constexpr std::uint32_t version = 2;
+
+using MIAConfig = std::decay_t<decltype(std::declval<PlenopticCameraConfig&>().mia())>;
+
+//Progress of a staged optimization (checkpoint of calibrate_anytime, see compote/checkpoint.h)
+struct Progress {
+	std::vector<double> fractions; //of the stages, ending with 1
+	std::uint64_t features = 0, centers = 0; //number of observations optimized
+	std::vector<std::uint64_t> observations; //of each completed stage
+	std::vector<double> seconds, costs; //of each completed stage
+	
+	std::size_t completed() const { return costs.size(); }
+};
+
+struct Snapshot {
+	std::optional<PlenopticCameraConfig> camera;
+	std::optional<InternalParameters> params;
+	std::optional<MIAConfig> mia; //stand-alone MIA (e.g., pre-calibration), the camera holds its own
+	std::optional<CalibrationPosesConfig> poses;
+	std::optional<Progress> progress;
+};
+
+//Check the magic number of a file
+bool is_snapshot(const std::string& path);
+
+void save(const std::string& path, const Snapshot& snapshot);
+Snapshot load(const std::string& path);
+
+//Camera ready to use (with its internal parameters if any), from a snapshot or a json configuration
+void load(const std::string& path, PlenopticCamera& mfpc);
+//Camera and internal parameters, each path being a snapshot or a json configuration
+void load(const std::string& camera, const std::string& params, PlenopticCamera& mfpc);
+
+//Camera configuration to camera, as libpleno's load(path, mfpc) does after parsing the json
+PlenopticCamera camera(const PlenopticCameraConfig& cfg);
+//Camera to camera configuration, as libpleno's save(path, mfpc) does before writing the file
+PlenopticCameraConfig config(const PlenopticCamera& mfpc);
+
+//Poses to poses configuration and back
+CalibrationPosesConfig config(const CalibrationPoses& poses);
+CalibrationPoses poses(const CalibrationPosesConfig& cfg);
+
+//Conversions, empty paths are ignored
+Snapshot from_json(
+	const std::string& camera, const std::string& params, 
+	const std::string& mia = "", const std::string& poses = ""
+);
+void to_json(
+	const Snapshot& snapshot, 
+	const std::string& camera, const std::string& params, 
+	const std::string& mia = "", const std::string& poses = ""
+);
+
+} //namespace compote::snapshot
@@ -0,0 +1,50 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Live convergence telemetry, one json record per line (JSONL) appended to a file (follow it with
+// tail -f) or sent to a listening unix socket (target "unix:<path>", e.g. socat UNIX-LISTEN:<path> -).
+// Records are flushed when written: {"t": seconds since enable, "solver": ..., "event": ..., fields}.
+// libpleno's solvers do not report their iterations, so the records are those of each solve run by
+// the anytime optimizations (stage of a schedule, batch of frames): "start", "end" (cost, time and
+// observations, plus the step of the stages and the inliers of the outlier pre-pass) and, while the 
+// solve runs, "running" heartbeats with the elapsed time. Only known fields are written, non-finite 
+// values as null. Telemetry is disabled (and costs a branch) until enable() is called.
+namespace compote::telemetry {
+
+using Fields = std::vector<std::pair<std::string, double>>;
+
+// Target is the path of a JSONL file or unix:<path>; heartbeats every period (s) while solving, 0 to disable
+void enable(const std::string& target, double period = 5.);
+bool enabled();
+
+void emit(const std::string& solver, const std::string& event, const Fields& fields = {});
+
+// A solve: emits "start", heartbeats while alive and "end" when closed
+class Solve {
+	std::string solver_;
+	double start_ = 0.;
+	
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	bool closed_ = false;
+	std::thread heartbeat_;
+
+public:
+	Solve(std::string solver, const Fields& fields);
+	~Solve();
+	
+	Solve(const Solve&) = delete;
+	Solve& operator=(const Solve&) = delete;
+	
+	// Emit "end" with the statistics of the solve (and its duration)
+	void close(const Fields& fields);
+};
+
+} //namespace compote::telemetry
@@ -0,0 +1,56 @@
+#pragma once
+
+//STD
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+// Stage-level tracing, written as a Chrome trace (json) viewable in chrome://tracing or Perfetto.
+// Every span records its wall time (event duration), the process cpu time and peak resident 
+// memory it consumed, and optional user arguments (e.g., number of items processed).
+// Tracing is disabled (and costs a branch) until enable() is called.
+namespace compote::trace {
+
+void enable(const std::string& path);
+bool enabled();
+
+// Close the current step and write the trace file (the file is also written at exit)
+void flush();
+
+// Record a counter value (e.g., observations per frame)
+void counter(const std::string& name, double value);
+
+class Scope {
+	std::string name_;
+	std::vector<std::pair<std::string, double>> args_;
+	
+	double ts_ = 0.; //us
+	double cpu_ = 0.; //us
+	bool active_ = false;
+	
+public:
+	explicit Scope(std::string name);
+	~Scope();
+	
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+	
+	void arg(const std::string& key, double value);
+	// Close the span (before end of scope)
+	void close();
+};
+
+// Numbered step of an application: closes the previous step of the calling thread and opens a new one
+void step(const std::string& name);
+// Item counts attached to the current step
+void step_arg(const std::string& key, double value);
+
+} //namespace compote::trace
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#define TRACE_SCOPE(name) compote::trace::Scope TRACE_CONCAT(trace_scope_, __LINE__){name}
+#define TRACE_STEP(name) compote::trace::step(name)
+#define TRACE_COUNTER(name, value) if (compote::trace::enabled()) compote::trace::counter(name, double(value))
@@ -0,0 +1,383 @@
+#include "compote/anytime.h"
+#include "compote/observations.h"
+#include "compote/residuals.h"
+#include "compote/trace.h"
+#include "compote/telemetry.h"
+
+//STD
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <algorithm>
+#include <set>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote {
+
+double Budget::remaining() const 
+{ 
+	return unlimited() ? std::numeric_limits<double>::infinity() : std::max(0., seconds - elapsed()); 
+}
+
+const char* to_string(StopReason reason)
+{
+	switch (reason)
+	{
+		case StopReason::Plateau: return "plateau";
+		case StopReason::Budget: return "budget";
+		default: return "completed";
+	}
+}
+
+void write_json(std::ostream& os, const AnytimeReport& report, const std::string& indent)
+{
+	os << "{\n";
+	os << indent << "\t\"stop\": \"" << to_string(report.reason) << "\", \"seconds\": " << report.seconds 
+		<< ", \"cost\": " << report.cost << ", \"skipped\": " << report.skipped << ",\n";
+	os << indent << "\t\"stages\": [";
+	for (std::size_t i = 0; i < report.stages.size(); ++i)
+	{
+		const auto& s = report.stages[i];
+		os << (i ? ",\n" : "\n") << indent << "\t\t{\"name\": \"" << s.name << "\", \"fraction\": " << s.fraction 
+			<< ", \"observations\": " << s.observations << ", \"seconds\": " << s.seconds << ", \"cost\": " << s.cost << "}";
+	}
+	os << (report.stages.empty() ? "" : "\n" + indent + "\t") << "]\n";
+	os << indent << "}";
+}
+
+void write_json(const std::string& path, const std::map<std::string, AnytimeReport>& reports)
+{
+	std::ofstream ofs(path);
+	if (not ofs) { PRINT_ERR("Can not write report = " << path); return; }
+	
+	ofs << "{";
+	std::size_t i = 0;
+	for (const auto& [name, report] : reports)
+	{
+		ofs << (i++ ? ",\n" : "\n") << "\t\"" << name << "\": ";
+		write_json(ofs, report, "\t");
+	}
+	ofs << "\n}\n";
+}
+
+namespace {
+
+double bap_cost(const PlenopticCamera& mfpc, const CheckerBoard& scene, const CalibrationPoses& poses, const BAPObservations& features)
+{
+	return aggregate(bap_residuals(mfpc, scene, poses, features)).all.rmse();
+}
+
+double mia_cost(const MIA& mia, const MICObservations& centers)
+{
+	double sumsq = 0.; std::size_t n = 0;
+	for (const auto& o : centers)
+	{
+		if (o.k < 0 or o.l < 0) continue;
+		const P2D c = mia.nodeInWorld(o.k, o.l);
+		sumsq += (c[0] - o.u) * (c[0] - o.u) + (c[1] - o.v) * (c[1] - o.v);
+		++n;
+	}
+	return (n > 0) ? std::sqrt(sumsq / n) : 0.;
+}
+
+//Step of a solve: rms displacement of the poses of the frames estimated before and after (mm), nan if none
+double pose_step(const CalibrationPoses& before, const CalibrationPoses& after)
+{
+	std::map<int, P3D> translations;
+	for (const auto& [p, f] : before) translations[f] = p.translation();
+	
+	double sumsq = 0.; std::size_t n = 0;
+	for (const auto& [p, f] : after)
+	{
+		const auto it = translations.find(f);
+		if (it == translations.end()) continue;
+		sumsq += (p.translation() - it->second).squaredNorm();
+		++n;
+	}
+	return (n > 0) ? std::sqrt(sumsq / n) : std::numeric_limits<double>::quiet_NaN();
+}
+
+//Step of a MIA solve: rms displacement of the observed nodes (pixel)
+double node_step(const MIA& before, const MIA& after, const MICObservations& centers)
+{
+	double sumsq = 0.; std::size_t n = 0;
+	for (const auto& o : centers)
+	{
+		if (o.k < 0 or o.l < 0) continue;
+		const P2D a = before.nodeInWorld(o.k, o.l), b = after.nodeInWorld(o.k, o.l);
+		sumsq += (b[0] - a[0]) * (b[0] - a[0]) + (b[1] - a[1]) * (b[1] - a[1]);
+		++n;
+	}
+	return (n > 0) ? std::sqrt(sumsq / n) : std::numeric_limits<double>::quiet_NaN();
+}
+
+//Duration of a solve on n observations, from the time per observation of the previous ones
+struct Predictor {
+	double seconds = 0.;
+	std::size_t observations = 0;
+	
+	bool known() const { return observations > 0; }
+	double operator()(std::size_t n) const { return known() ? seconds * n / observations : 0.; }
+	void add(double s, std::size_t n) { seconds += s; observations += n; }
+};
+
+//Whether a solve on n observations can be started within the budget
+bool fits(const Budget& budget, const Predictor& predict, std::size_t n)
+{
+	if (budget.expired()) return false;
+	return not predict.known() or predict(n) <= budget.remaining();
+}
+
+//Relative decrease of the cost below the plateau threshold
+bool plateau(const Budget& budget, const AnytimeReport& report)
+{
+	if (budget.plateau <= 0. or report.stages.size() < 2) return false;
+	
+	const double previous = report.stages[report.stages.size() - 2].cost;
+	const double current = report.stages.back().cost;
+	return previous > 0. and (previous - current) / previous < budget.plateau;
+}
+
+} //namespace
+
+AnytimeReport calibrate_anytime(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const Schedule& schedule,
+	const Budget& budget,
+	const StageCallback& on_stage,
+	const AnytimeReport& previous
+)
+{
+	AnytimeReport report;
+	report.stages = previous.stages;
+	
+	Predictor predict;
+	for (const auto& s : previous.stages) predict.add(s.seconds, s.observations);
+	
+	PlenopticCamera best = mfpc;
+	CalibrationPoses best_poses = poses;
+	const std::vector<double> fractions = schedule.stages();
+	
+	//cost of the estimate kept by the previous run
+	double best_cost = std::numeric_limits<double>::infinity();
+	for (const auto& s : previous.stages) best_cost = std::min(best_cost, s.cost);
+	if (previous.stages.size() >= fractions.size()) best_cost = previous.stages.back().cost;
+	
+	if (not previous.stages.empty()) 
+		PRINT_INFO("=== Resuming after stage " << previous.stages.size() - 1 << " (" << fractions.size() << " stages)");
+	
+	for (std::size_t i = previous.stages.size(); i < fractions.size(); ++i)
+	{
+		const double fraction = fractions[i];
+		const BAPObservations subset = (fraction < 1.) ? decimate(features, mfpc, fraction, schedule.zones) : BAPObservations{};
+		const MICObservations centers_subset = (fraction < 1.) ? decimate(centers, mfpc, fraction, schedule.zones) : MICObservations{};
+		const BAPObservations& f = (fraction < 1.) ? subset : features;
+		const MICObservations& c = (fraction < 1.) ? centers_subset : centers;
+		
+		if (not fits(budget, predict, f.size() + c.size()))
+		{
+			PRINT_WARN("Budget: stopping before stage " << i << " (" << budget.elapsed() << " s elapsed, " 
+				<< predict(f.size() + c.size()) << " s predicted, " << budget.remaining() << " s remaining)");
+			report.reason = StopReason::Budget;
+			report.skipped = fractions.size() - i;
+			break;
+		}
+		
+		telemetry::Solve solve{"calibration", {{"stage", double(i)}, {"fraction", fraction}, {"observations", double(f.size() + c.size())}}};
+		const CalibrationPoses before = telemetry::enabled() ? poses : CalibrationPoses{};
+		
+		const auto start = Budget::clock::now();
+		{
+			compote::trace::Scope scope{fraction < 1. ? "calibration_PlenopticCamera (coarse)" : "calibration_PlenopticCamera"};
+			scope.arg("fraction", fraction);
+			scope.arg("bap observations", f.size());
+			scope.arg("center observations", c.size());
+			
+			PRINT_INFO("=== Stage " << i << ": " << 100. * fraction << "% of observations (" << f.size() << " features, " << c.size() << " centers)");
+			CalibrationPoses stage = poses; //starting from the poses of the previous stage
+			calibration_PlenopticCamera(stage, mfpc, scene, f, c, pictures);
+			poses = std::move(stage);
+		}
+		const double seconds = std::chrono::duration<double>(Budget::clock::now() - start).count();
+		predict.add(seconds, f.size() + c.size());
+		
+		const double cost = bap_cost(mfpc, scene, poses, features);
+		report.stages.push_back(StageStats{"stage-" + std::to_string(i), fraction, f.size() + c.size(), seconds, cost});
+		PRINT_INFO("=== Stage " << i << ": rmse = " << cost << " (" << seconds << " s)");
+		solve.close({{"stage", double(i)}, {"cost", cost}, {"step", pose_step(before, poses)}, 
+			{"observations", double(f.size() + c.size())}});
+		
+		//the estimate on every observation is kept when completed, otherwise the best one
+		if (fraction >= 1. or cost <= best_cost) { best = mfpc; best_poses = poses; best_cost = cost; }
+		if (on_stage) on_stage(best, best_poses, report);
+		
+		if (i + 1 < fractions.size() and plateau(budget, report))
+		{
+			PRINT_WARN("Plateau: stopping after stage " << i);
+			report.reason = StopReason::Plateau;
+			report.skipped = fractions.size() - i - 1;
+			break;
+		}
+	}
+	
+	mfpc = best; poses = best_poses;
+	report.cost = std::isfinite(best_cost) ? best_cost : 0.;
+	report.seconds = budget.elapsed();
+	return report;
+}
+
+AnytimeReport calibrate_mia_anytime(
+	MIA& mia,
+	const MICObservations& centers,
+	std::size_t width, std::size_t height,
+	const Schedule& schedule,
+	const Budget& budget
+)
+{
+	AnytimeReport report;
+	Predictor predict;
+	
+	MIA best = mia;
+	double best_cost = std::numeric_limits<double>::infinity();
+	
+	const std::vector<double> fractions = schedule.stages();
+	for (std::size_t i = 0; i < fractions.size(); ++i)
+	{
+		const double fraction = fractions[i];
+		const MICObservations subset = (fraction < 1.) ? decimate(centers, width, height, fraction, schedule.zones) : MICObservations{};
+		const MICObservations& c = (fraction < 1.) ? subset : centers;
+		
+		if (not fits(budget, predict, c.size()))
+		{
+			PRINT_WARN("Budget: stopping MIA calibration before stage " << i);
+			report.reason = StopReason::Budget;
+			report.skipped = fractions.size() - i;
+			break;
+		}
+		
+		telemetry::Solve solve{"mia", {{"stage", double(i)}, {"fraction", fraction}, {"observations", double(c.size())}}};
+		const MIA before = mia;
+		
+		const auto start = Budget::clock::now();
+		{
+			compote::trace::Scope scope{"calibration_MIA"};
+			scope.arg("fraction", fraction);
+			scope.arg("center observations", c.size());
+			calibration_MIA(mia, c);
+		}
+		const double seconds = std::chrono::duration<double>(Budget::clock::now() - start).count();
+		predict.add(seconds, c.size());
+		
+		const double cost = mia_cost(mia, centers);
+		report.stages.push_back(StageStats{"stage-" + std::to_string(i), fraction, c.size(), seconds, cost});
+		solve.close({{"stage", double(i)}, {"cost", cost}, {"step", node_step(before, mia, centers)}, 
+			{"observations", double(c.size())}});
+		
+		if (fraction >= 1. or cost <= best_cost) { best = mia; best_cost = cost; }
+		
+		if (i + 1 < fractions.size() and plateau(budget, report))
+		{
+			report.reason = StopReason::Plateau;
+			report.skipped = fractions.size() - i - 1;
+			break;
+		}
+	}
+	
+	mia = best;
+	report.cost = std::isfinite(best_cost) ? best_cost : 0.;
+	report.seconds = budget.elapsed();
+	return report;
+}
+
+AnytimeReport extrinsics_anytime(
+	CalibrationPoses& poses,
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures,
+	const Budget& budget,
+	std::size_t batch
+)
+{
+	AnytimeReport report;
+	Predictor predict;
+	
+	//observations of a batch of frames are gathered from their ranges, without scanning every feature
+	const IndexedObservations indexed{features};
+	const std::vector<int> frames = indexed.frames();
+	batch = std::max<std::size_t>(1, batch);
+	
+	poses.clear();
+	const std::size_t nbatches = (frames.size() + batch - 1) / batch;
+	for (std::size_t b = 0; b < nbatches; ++b)
+	{
+		const std::set<int> selected(frames.begin() + b * batch, frames.begin() + std::min(frames.size(), (b + 1) * batch));
+		BAPObservations subset;
+		for (const int f : selected) { const auto range = indexed.frame(f); subset.insert(subset.end(), range.begin(), range.end()); }
+		
+		if (not fits(budget, predict, subset.size()))
+		{
+			PRINT_WARN("Budget: stopping extrinsics after " << b * batch << " frames out of " << frames.size());
+			report.reason = StopReason::Budget;
+			report.skipped = nbatches - b;
+			break;
+		}
+		
+		telemetry::Solve solve{"extrinsics", {{"batch", double(b)}, {"frames", double(selected.size())}, {"observations", double(subset.size())}}};
+		
+		const auto start = Budget::clock::now();
+		CalibrationPoses batch_poses;
+		{
+			compote::trace::Scope scope{"calibration_ExtrinsicsPlenopticCamera"};
+			scope.arg("frames", selected.size());
+			scope.arg("bap observations", subset.size());
+			calibration_ExtrinsicsPlenopticCamera(batch_poses, mfpc, scene, subset, pictures);
+		}
+		const double seconds = std::chrono::duration<double>(Budget::clock::now() - start).count();
+		predict.add(seconds, subset.size());
+		
+		const double cost = bap_cost(mfpc, scene, batch_poses, subset);
+		report.stages.push_back(StageStats{"frames-" + std::to_string(*selected.begin()) + "-" + std::to_string(*selected.rbegin()), 
+			double(subset.size()) / std::max<std::size_t>(1, features.size()), subset.size(), seconds, cost});
+		solve.close({{"batch", double(b)}, {"cost", cost}, {"observations", double(subset.size())}});
+		
+		poses.insert(poses.end(), batch_poses.begin(), batch_poses.end());
+	}
+	
+	report.cost = bap_cost(mfpc, scene, poses, features);
+	report.seconds = budget.elapsed();
+	return report;
+}
+
+Watchdog::Watchdog(const Budget& budget, std::function<void()> on_expiry)
+{
+	if (budget.unlimited()) return;
+	
+	const auto deadline = budget.start + std::chrono::duration_cast<Budget::clock::duration>(std::chrono::duration<double>(budget.seconds));
+	thread_ = std::thread([this, deadline, on_expiry = std::move(on_expiry)]() {
+		std::unique_lock<std::mutex> lock{mutex_};
+		if (cv_.wait_until(lock, deadline, [this]() { return cancelled_; })) return;
+		lock.unlock();
+		
+		on_expiry();
+	});
+}
+
+Watchdog::~Watchdog()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		cancelled_ = true;
+	}
+	cv_.notify_all();
+	if (thread_.joinable()) thread_.join();
+}
+
+} //namespace compote
@@ -0,0 +1,93 @@
+#include "compote/checkpoint.h"
+#include "compote/trace.h"
+
+//STD
+#include <cmath>
+#include <fstream>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote::checkpoint {
+
+namespace {
+
+bool same(const std::vector<double>& a, const std::vector<double>& b)
+{
+	if (a.size() != b.size()) return false;
+	for (std::size_t i = 0; i < a.size(); ++i) if (std::abs(a[i] - b[i]) > 1e-12) return false;
+	return true;
+}
+
+} //namespace
+
+snapshot::Progress progress(const Schedule& schedule, std::size_t features, std::size_t centers, const AnytimeReport& report)
+{
+	snapshot::Progress p;
+	p.fractions = schedule.stages();
+	p.features = features; p.centers = centers;
+	for (const auto& s : report.stages)
+	{
+		p.observations.emplace_back(s.observations);
+		p.seconds.emplace_back(s.seconds);
+		p.costs.emplace_back(s.cost);
+	}
+	return p;
+}
+
+void save(const std::string& path, const PlenopticCamera& mfpc, const CalibrationPoses& poses, const snapshot::Progress& progress)
+{
+	TRACE_SCOPE("checkpoint::save");
+	
+	snapshot::Snapshot s;
+	s.camera = snapshot::config(mfpc);
+	s.params = mfpc.params();
+	s.poses = snapshot::config(poses);
+	s.progress = progress;
+	
+	snapshot::save(path, s);
+	PRINT_DEBUG("Checkpoint saved after " << progress.completed() << " stages in " << path);
+}
+
+std::optional<State> load(const std::string& path, const Schedule& schedule, std::size_t features, std::size_t centers)
+{
+	if (not std::ifstream(path)) { PRINT_WARN("No checkpoint " << path << ", starting from scratch"); return std::nullopt; }
+	if (not snapshot::is_snapshot(path)) { PRINT_WARN("Checkpoint " << path << " is not a snapshot, starting from scratch"); return std::nullopt; }
+	
+	const snapshot::Snapshot s = snapshot::load(path);
+	if (not s.camera or not s.params or not s.poses or not s.progress)
+	{
+		PRINT_WARN("Checkpoint " << path << " is incomplete, starting from scratch");
+		return std::nullopt;
+	}
+	
+	const snapshot::Progress& p = *s.progress;
+	if (not same(p.fractions, schedule.stages()) or p.features != features or p.centers != centers)
+	{
+		PRINT_WARN("Checkpoint " << path << " belongs to another run (" << p.fractions.size() << " stages, "
+			<< p.features << " features, " << p.centers << " centers), starting from scratch");
+		return std::nullopt;
+	}
+	
+	State state;
+	state.mfpc = snapshot::camera(*s.camera);
+	state.mfpc.params() = *s.params;
+	state.poses = snapshot::poses(*s.poses);
+	
+	for (std::size_t i = 0; i < p.completed() and i < p.fractions.size(); ++i)
+		state.report.stages.push_back(StageStats{"stage-" + std::to_string(i), p.fractions[i], p.observations[i], p.seconds[i], p.costs[i]});
+	state.report.cost = p.costs.empty() ? 0. : p.costs.back();
+	
+	PRINT_INFO("Resuming from checkpoint " << path << ": " << p.completed() << "/" << p.fractions.size() << " stages completed");
+	return state;
+}
+
+StageCallback writer(const std::string& path, const Schedule& schedule, std::size_t features, std::size_t centers)
+{
+	return [=](const PlenopticCamera& mfpc, const CalibrationPoses& poses, const AnytimeReport& report) {
+		try { save(path, mfpc, poses, progress(schedule, features, centers, report)); }
+		catch (const std::exception& e) { PRINT_ERR("Can not save checkpoint: " << e.what()); }
+	};
+}
+
+} //namespace compote::checkpoint
@@ -0,0 +1,523 @@
+#include "compote/codec.h"
+#include "compote/trace.h"
+
+//STD
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <unistd.h>
+
+//BOOST
+#include <boost/filesystem.hpp>
+
+//ZLIB
+#include <zlib.h>
+//ZSTD
+#if defined(COMPOTE_WITH_ZSTD)
+#include <zstd.h>
+#endif
+//LZ4
+#if defined(COMPOTE_WITH_LZ4)
+#include <lz4frame.h>
+#endif
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote::codec {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+constexpr unsigned char gzip_magic[] = {0x1f, 0x8b};
+constexpr unsigned char zstd_magic[] = {0x28, 0xb5, 0x2f, 0xfd};
+constexpr unsigned char lz4_magic[] = {0x04, 0x22, 0x4d, 0x18};
+
+constexpr std::size_t lz4_chunk = 4 << 20; //bytes of input per lz4 frame
+
+template<std::size_t N>
+bool starts_with(const char* data, std::size_t size, const unsigned char (&magic)[N])
+{
+	return size >= N and std::memcmp(data, magic, N) == 0;
+}
+
+Codec detect(const char* data, std::size_t size)
+{
+	if (starts_with(data, size, gzip_magic)) return Codec::Gzip;
+	if (starts_with(data, size, zstd_magic)) return Codec::Zstd;
+	if (starts_with(data, size, lz4_magic)) return Codec::LZ4;
+	return Codec::None;
+}
+
+std::size_t nb_threads(std::size_t threads)
+{
+	return (threads == 0) ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+}
+
+std::string lower(std::string s)
+{
+	std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+	return s;
+}
+
+constexpr std::size_t chunk = 1 << 20; //bytes read and written at once when streaming
+
+//Read up to the size of the buffer, return the number of bytes read (less only at the end of the stream)
+std::size_t read_chunk(std::istream& is, char* data, std::size_t size)
+{
+	is.read(data, size);
+	if (is.bad()) throw std::runtime_error("codec: read failed");
+	return std::size_t(is.gcount());
+}
+
+void write_chunk(std::ostream& os, const char* data, std::size_t size)
+{
+	if (size > 0 and not os.write(data, size)) throw std::runtime_error("codec: write failed");
+}
+
+void copy(std::istream& is, std::ostream& os)
+{
+	std::vector<char> buffer(chunk);
+	std::size_t n;
+	while ((n = read_chunk(is, buffer.data(), buffer.size())) > 0) write_chunk(os, buffer.data(), n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// gzip
+////////////////////////////////////////////////////////////////////////////////
+void gzip_compress(std::istream& is, std::ostream& os, int level)
+{
+	z_stream zs{};
+	if (deflateInit2(&zs, (level > 0 ? level : Z_DEFAULT_COMPRESSION), Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw std::runtime_error("codec: gzip initialization failed");
+
+	std::vector<char> in(chunk), out(chunk);
+	int flush = Z_NO_FLUSH;
+	try
+	{
+		do
+		{
+			const std::size_t n = read_chunk(is, in.data(), in.size());
+			flush = (n < in.size()) ? Z_FINISH : Z_NO_FLUSH;
+			zs.next_in = reinterpret_cast<Bytef*>(in.data());
+			zs.avail_in = n;
+
+			do
+			{
+				zs.next_out = reinterpret_cast<Bytef*>(out.data());
+				zs.avail_out = out.size();
+				if (deflate(&zs, flush) == Z_STREAM_ERROR) throw std::runtime_error("codec: gzip compression failed");
+				write_chunk(os, out.data(), out.size() - zs.avail_out);
+			}
+			while (zs.avail_out == 0);
+		}
+		while (flush != Z_FINISH);
+	}
+	catch (...) { deflateEnd(&zs); throw; }
+	deflateEnd(&zs);
+}
+
+void gzip_decompress(std::istream& is, std::ostream& os)
+{
+	z_stream zs{};
+	if (inflateInit2(&zs, 15 + 32) != Z_OK) throw std::runtime_error("codec: gzip initialization failed");
+
+	std::vector<char> in(chunk), out(chunk);
+	int ret = Z_OK;
+	try
+	{
+		std::size_t n;
+		while ((n = read_chunk(is, in.data(), in.size())) > 0)
+		{
+			zs.next_in = reinterpret_cast<Bytef*>(in.data());
+			zs.avail_in = n;
+
+			do
+			{
+				if (ret == Z_STREAM_END)
+				{
+					if (zs.avail_in == 0) break;
+					inflateReset(&zs); //concatenated members
+				}
+
+				zs.next_out = reinterpret_cast<Bytef*>(out.data());
+				zs.avail_out = out.size();
+				ret = inflate(&zs, Z_NO_FLUSH);
+				if (ret != Z_OK and ret != Z_STREAM_END and ret != Z_BUF_ERROR) throw std::runtime_error("codec: gzip decompression failed");
+				write_chunk(os, out.data(), out.size() - zs.avail_out);
+			}
+			while (zs.avail_in > 0 or zs.avail_out == 0);
+		}
+		if (ret != Z_STREAM_END) throw std::runtime_error("codec: truncated gzip data");
+	}
+	catch (...) { inflateEnd(&zs); throw; }
+	inflateEnd(&zs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// zstd
+////////////////////////////////////////////////////////////////////////////////
+#if defined(COMPOTE_WITH_ZSTD)
+void zstd_compress(std::istream& is, std::ostream& os, const Options& options)
+{
+	ZSTD_CCtx* cctx = ZSTD_createCCtx();
+	if (not cctx) throw std::runtime_error("codec: zstd initialization failed");
+
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, (options.level > 0 ? options.level : ZSTD_CLEVEL_DEFAULT));
+	ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+
+	//no effect if libzstd was built without multi-threading
+	const std::size_t threads = nb_threads(options.threads);
+	if (threads > 1) ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, int(threads));
+
+	std::vector<char> in(chunk), out(ZSTD_CStreamOutSize());
+	try
+	{
+		bool last = false;
+		while (not last)
+		{
+			const std::size_t n = read_chunk(is, in.data(), in.size());
+			last = (n < in.size());
+
+			ZSTD_inBuffer input{in.data(), n, 0};
+			bool done = false;
+			while (not done)
+			{
+				ZSTD_outBuffer o{out.data(), out.size(), 0};
+				const std::size_t remaining = ZSTD_compressStream2(cctx, &o, &input, (last ? ZSTD_e_end : ZSTD_e_continue));
+				if (ZSTD_isError(remaining)) throw std::runtime_error(std::string("codec: zstd compression failed: ") + ZSTD_getErrorName(remaining));
+				write_chunk(os, out.data(), o.pos);
+				done = last ? (remaining == 0) : (input.pos == input.size);
+			}
+		}
+	}
+	catch (...) { ZSTD_freeCCtx(cctx); throw; }
+	ZSTD_freeCCtx(cctx);
+}
+
+void zstd_decompress(std::istream& is, std::ostream& os)
+{
+	ZSTD_DCtx* dctx = ZSTD_createDCtx();
+	if (not dctx) throw std::runtime_error("codec: zstd initialization failed");
+
+	std::vector<char> in(ZSTD_DStreamInSize()), out(ZSTD_DStreamOutSize());
+	try
+	{
+		std::size_t ret = 0, n;
+		while ((n = read_chunk(is, in.data(), in.size())) > 0)
+		{
+			ZSTD_inBuffer input{in.data(), n, 0};
+			while (input.pos < input.size)
+			{
+				ZSTD_outBuffer o{out.data(), out.size(), 0};
+				ret = ZSTD_decompressStream(dctx, &o, &input);
+				if (ZSTD_isError(ret)) throw std::runtime_error(std::string("codec: zstd decompression failed: ") + ZSTD_getErrorName(ret));
+				write_chunk(os, out.data(), o.pos);
+			}
+		}
+		//flush what is still buffered in the context
+		while (ret != 0)
+		{
+			ZSTD_inBuffer input{nullptr, 0, 0};
+			ZSTD_outBuffer o{out.data(), out.size(), 0};
+			ret = ZSTD_decompressStream(dctx, &o, &input);
+			if (ZSTD_isError(ret)) throw std::runtime_error(std::string("codec: zstd decompression failed: ") + ZSTD_getErrorName(ret));
+			write_chunk(os, out.data(), o.pos);
+			if (o.pos == 0 and ret != 0) throw std::runtime_error("codec: truncated zstd data"); //no progress
+		}
+	}
+	catch (...) { ZSTD_freeDCtx(dctx); throw; }
+	ZSTD_freeDCtx(dctx);
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// lz4
+////////////////////////////////////////////////////////////////////////////////
+#if defined(COMPOTE_WITH_LZ4)
+void lz4_compress(std::istream& is, std::ostream& os, const Options& options)
+{
+	LZ4F_preferences_t prefs;
+	std::memset(&prefs, 0, sizeof(prefs));
+	prefs.compressionLevel = options.level;
+	prefs.frameInfo.blockSizeID = LZ4F_max4MB;
+	prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+	//independent frames: a batch of chunks (one per thread) is read, compressed concurrently,
+	//and the frames are written in order
+	const std::size_t threads = nb_threads(options.threads);
+	std::vector<std::string> inputs(threads), frames(threads);
+	std::vector<std::size_t> errors(threads, 0);
+
+	bool last = false, empty = true;
+	while (not last)
+	{
+		std::size_t count = 0;
+		while (count < threads and not last)
+		{
+			std::string& input = inputs[count];
+			input.resize(lz4_chunk);
+			input.resize(read_chunk(is, input.data(), input.size()));
+			last = (input.size() < lz4_chunk);
+			if (input.empty() and not empty) break; //nothing left, an empty input still gets a frame
+			empty = false; ++count;
+		}
+
+		auto work = [&](std::size_t t) {
+			for (std::size_t c = t; c < count; c += threads)
+			{
+				LZ4F_preferences_t p = prefs;
+				p.frameInfo.contentSize = inputs[c].size();
+
+				std::string& frame = frames[c];
+				frame.resize(LZ4F_compressFrameBound(inputs[c].size(), &p));
+				const std::size_t n = LZ4F_compressFrame(frame.data(), frame.size(), inputs[c].data(), inputs[c].size(), &p);
+				errors[c] = LZ4F_isError(n) ? n : 0;
+				if (errors[c] == 0) frame.resize(n);
+			}
+		};
+
+		std::vector<std::thread> workers;
+		for (std::size_t t = 1; t < count; ++t) workers.emplace_back(work, t);
+		work(0);
+		for (auto& w : workers) w.join();
+
+		for (std::size_t c = 0; c < count; ++c)
+		{
+			if (errors[c] != 0) throw std::runtime_error(std::string("codec: lz4 compression failed: ") + LZ4F_getErrorName(errors[c]));
+			write_chunk(os, frames[c].data(), frames[c].size());
+		}
+	}
+}
+
+void lz4_decompress(std::istream& is, std::ostream& os)
+{
+	LZ4F_dctx* dctx = nullptr;
+	if (LZ4F_isError(LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION))) throw std::runtime_error("codec: lz4 initialization failed");
+
+	std::vector<char> in(chunk), out(4 << 20);
+	try
+	{
+		std::size_t ret = 0, n;
+		while ((n = read_chunk(is, in.data(), in.size())) > 0)
+		{
+			const char* src = in.data();
+			const char* end = in.data() + n;
+			while (src < end)
+			{
+				std::size_t dst_size = out.size(), src_size = end - src;
+				ret = LZ4F_decompress(dctx, out.data(), &dst_size, src, &src_size, nullptr);
+				if (LZ4F_isError(ret)) throw std::runtime_error(std::string("codec: lz4 decompression failed: ") + LZ4F_getErrorName(ret));
+				write_chunk(os, out.data(), dst_size);
+				src += src_size;
+			}
+		}
+		if (ret != 0) throw std::runtime_error("codec: truncated lz4 data");
+	}
+	catch (...) { LZ4F_freeDecompressionContext(dctx); throw; }
+	LZ4F_freeDecompressionContext(dctx);
+}
+#endif
+
+void compress(std::istream& is, std::ostream& os, Codec codec, const Options& options)
+{
+	switch (codec)
+	{
+		case Codec::None: copy(is, os); return;
+		case Codec::Gzip: gzip_compress(is, os, options.level); return;
+#if defined(COMPOTE_WITH_ZSTD)
+		case Codec::Zstd: zstd_compress(is, os, options); return;
+#endif
+#if defined(COMPOTE_WITH_LZ4)
+		case Codec::LZ4: lz4_compress(is, os, options); return;
+#endif
+		default: throw std::runtime_error(std::string("codec: ") + name(codec) + " support not compiled in");
+	}
+}
+
+void decompress(std::istream& is, std::ostream& os, Codec codec)
+{
+	switch (codec)
+	{
+		case Codec::None: copy(is, os); return;
+		case Codec::Gzip: gzip_decompress(is, os); return;
+#if defined(COMPOTE_WITH_ZSTD)
+		case Codec::Zstd: zstd_decompress(is, os); return;
+#endif
+#if defined(COMPOTE_WITH_LZ4)
+		case Codec::LZ4: lz4_decompress(is, os); return;
+#endif
+		default: throw std::runtime_error(std::string("codec: ") + name(codec) + " support not compiled in");
+	}
+}
+
+} //namespace
+
+const char* name(Codec codec)
+{
+	switch (codec)
+	{
+		case Codec::Gzip: return "gzip";
+		case Codec::Zstd: return "zstd";
+		case Codec::LZ4: return "lz4";
+		default: return "none";
+	}
+}
+
+const char* extension(Codec codec)
+{
+	switch (codec)
+	{
+		case Codec::Gzip: return ".gz";
+		case Codec::Zstd: return ".zst";
+		case Codec::LZ4: return ".lz4";
+		default: return "";
+	}
+}
+
+bool available(Codec codec)
+{
+	switch (codec)
+	{
+#if defined(COMPOTE_WITH_ZSTD)
+		case Codec::Zstd: return true;
+#endif
+#if defined(COMPOTE_WITH_LZ4)
+		case Codec::LZ4: return true;
+#endif
+		case Codec::None: case Codec::Gzip: return true;
+		default: return false;
+	}
+}
+
+Codec parse(const std::string& s)
+{
+	const std::string n = lower(s);
+	if (n == "none") return Codec::None;
+	if (n == "gzip" or n == "gz") return Codec::Gzip;
+	if (n == "zstd" or n == "zst") return Codec::Zstd;
+	if (n == "lz4") return Codec::LZ4;
+	throw std::runtime_error("codec: unknown codec " + s);
+}
+
+Codec select(const std::string& s)
+{
+	const Codec codec = parse(s);
+	if (available(codec)) return codec;
+
+	PRINT_WARN("codec: " << name(codec) << " support not compiled in, using gzip");
+	return Codec::Gzip;
+}
+
+Codec from_extension(const std::string& path)
+{
+	const std::string ext = lower(fs::path(path).extension().string());
+	if (ext == ".gz") return Codec::Gzip;
+	if (ext == ".zst") return Codec::Zstd;
+	if (ext == ".lz4") return Codec::LZ4;
+	return Codec::None;
+}
+
+Codec detect(const std::string& path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (not ifs) throw std::runtime_error("codec: cannot read " + path);
+
+	char magic[4] = {};
+	ifs.read(magic, sizeof(magic));
+	return detect(magic, std::size_t(ifs.gcount()));
+}
+
+std::string path(const std::string& stem, Codec codec)
+{
+	return stem + extension(codec);
+}
+
+std::string compress(const std::string& data, Codec codec, const Options& options)
+{
+	if (codec == Codec::None) return data;
+
+	std::istringstream is(data);
+	std::ostringstream os;
+	compress(is, os, codec, options);
+	return os.str();
+}
+
+std::string decompress(const std::string& data)
+{
+	const Codec codec = detect(data.data(), data.size());
+	if (codec == Codec::None) return data;
+
+	std::istringstream is(data);
+	std::ostringstream os;
+	decompress(is, os, codec);
+	return os.str();
+}
+
+void compress(const std::string& src, const std::string& dst, Codec codec, const Options& options)
+{
+	TRACE_SCOPE("compote::codec::compress");
+
+	std::ifstream ifs(src, std::ios::binary);
+	if (not ifs) throw std::runtime_error("codec: cannot read " + src);
+	std::ofstream ofs(dst, std::ios::binary);
+	if (not ofs) throw std::runtime_error("codec: cannot write " + dst);
+
+	compress(ifs, ofs, codec, options);
+	if (not ofs.flush()) throw std::runtime_error("codec: cannot write " + dst);
+}
+
+void decompress(const std::string& src, const std::string& dst)
+{
+	TRACE_SCOPE("compote::codec::decompress");
+
+	const Codec codec = detect(src);
+	std::ifstream ifs(src, std::ios::binary);
+	if (not ifs) throw std::runtime_error("codec: cannot read " + src);
+	std::ofstream ofs(dst, std::ios::binary);
+	if (not ofs) throw std::runtime_error("codec: cannot write " + dst);
+
+	decompress(ifs, ofs, codec);
+	if (not ofs.flush()) throw std::runtime_error("codec: cannot write " + dst);
+}
+
+namespace detail {
+
+std::string scratch()
+{
+	//memory-backed, so that the uncompressed artifact never reaches the disk (nor a shared filesystem)
+	static const fs::path dir = []() {
+		boost::system::error_code ec;
+		const fs::path shm{"/dev/shm"};
+		if (fs::is_directory(shm, ec) and ::access(shm.c_str(), W_OK) == 0) return shm;
+		return fs::temp_directory_path();
+	}();
+	return dir.string();
+}
+
+std::string temporary(const std::string& path)
+{
+	fs::path p{path};
+	if (from_extension(path) != Codec::None) p.replace_extension(); //observations.bin.zst -> observations.bin
+
+	std::string ext = p.extension().string();
+	if (ext.empty()) ext = ".bin";
+
+	return (fs::path(scratch()) / fs::unique_path("compote-" + p.stem().string() + "-%%%%-%%%%" + ext)).string();
+}
+
+void remove(const std::string& path)
+{
+	boost::system::error_code ec;
+	fs::remove(path, ec);
+}
+
+} //namespace detail
+
+} //namespace compote::codec
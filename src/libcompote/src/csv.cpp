@@ -0,0 +1,453 @@
+#include "compote/csv.h"
+#include "compote/trace.h"
+#include "compote/codec.h"
+
+//STD
+#include <array>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+//POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//BOOST
+#include <boost/filesystem.hpp>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote::csv {
+
+namespace {
+
+enum Column { K, L, U, V, RHO, CLUSTER, FRAME, INLIER, NB_COLUMNS };
+constexpr const char* names[NB_COLUMNS] = {"k", "l", "u", "v", "rho", "cluster", "frame", "inlier"};
+
+constexpr std::size_t min_chunk = 1 << 20; //bytes parsed per thread at least
+constexpr std::size_t max_row = 192; //characters of a formatted row at most
+
+//Read-only memory mapping of a whole file
+class MappedFile {
+	const char* data_ = nullptr;
+	std::size_t size_ = 0;
+
+public:
+	explicit MappedFile(const std::string& path)
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw std::runtime_error("csv: cannot open " + path);
+
+		struct stat st;
+		if (::fstat(fd, &st) == 0 and st.st_size > 0)
+		{
+			void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr != MAP_FAILED)
+			{
+				data_ = static_cast<const char*>(addr);
+				size_ = st.st_size;
+				::madvise(addr, size_, MADV_SEQUENTIAL);
+			}
+		}
+		::close(fd);
+
+		if (not data_) throw std::runtime_error("csv: cannot map " + path + " (empty file?)");
+	}
+	~MappedFile() { ::munmap(const_cast<char*>(data_), size_); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* begin() const { return data_; }
+	const char* end() const { return data_ + size_; }
+};
+
+bool is_blank(char c) { return c == ' ' or c == '\t'; }
+
+//Column of each field of a row (-1 if ignored), and position of the first row
+struct Header {
+	std::vector<int> columns;
+	std::array<bool, NB_COLUMNS> has{};
+	const char* body = nullptr;
+
+	Kind kind() const
+	{
+		if (not (has[K] and has[L] and has[U] and has[V])) return Kind::Unknown;
+		return has[RHO] ? Kind::Features : Kind::Centers;
+	}
+};
+
+Header parse_header(const char* first, const char* last)
+{
+	Header header;
+
+	const char* eol = std::find(first, last, '\n');
+	header.body = (eol < last) ? eol + 1 : last;
+
+	while (first <= eol and first < last)
+	{
+		const char* sep = std::find(first, eol, ',');
+
+		const char* b = first; const char* e = sep;
+		while (b < e and (is_blank(*b) or *b == '"')) ++b;
+		while (e > b and (is_blank(e[-1]) or e[-1] == '"' or e[-1] == '\r')) --e;
+
+		std::string name(b, e);
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+
+		int column = -1;
+		for (int c = 0; c < NB_COLUMNS; ++c) if (name == names[c] and not header.has[c]) { column = c; break; }
+		if (column >= 0) header.has[column] = true;
+		header.columns.push_back(column);
+
+		first = sep + 1;
+	}
+
+	return header;
+}
+
+//Parse a double in [first, last), return the position after it or nullptr on failure
+const char* parse(const char* first, const char* last, double& value)
+{
+#if defined(__cpp_lib_to_chars)
+	const auto [ptr, ec] = std::from_chars(first, last, value);
+	return (ec == std::errc{}) ? ptr : nullptr;
+#else //no floating-point from_chars (gcc < 11): copy the token for strtod
+	char buf[64];
+	std::size_t n = 0;
+	while (first + n < last and n < sizeof(buf) - 1 and not std::strchr(", \t\r\n", first[n])) ++n;
+	std::memcpy(buf, first, n); buf[n] = '\0';
+
+	char* end = nullptr;
+	value = std::strtod(buf, &end);
+	return (end != buf) ? first + (end - buf) : nullptr;
+#endif
+}
+
+//Parse the rows of [first, last), call f(values) for each well-formed row, return the number of malformed rows
+template<typename F>
+std::size_t parse_rows(const char* first, const char* last, const Header& header, F&& f)
+{
+	std::size_t malformed = 0;
+	std::array<double, NB_COLUMNS> values;
+
+	const char* it = first;
+	while (it < last)
+	{
+		const char* eol = std::find(it, last, '\n');
+
+		//skip blank lines
+		const char* p = it;
+		while (p < eol and (is_blank(*p) or *p == '\r')) ++p;
+		if (p == eol) { it = eol + 1; continue; }
+
+		bool ok = true;
+		p = it;
+		for (std::size_t i = 0; ok and i < header.columns.size(); ++i)
+		{
+			if (i > 0) { if (p < eol and *p == ',') ++p; else { ok = false; break; } }
+			while (p < eol and is_blank(*p)) ++p;
+
+			const int column = header.columns[i];
+			if (column < 0) { p = std::find(p, eol, ','); continue; }
+
+			p = parse(p, eol, values[column]);
+			if (not p) { ok = false; break; }
+			while (p < eol and (is_blank(*p) or *p == '\r')) ++p;
+		}
+		if (ok and p != eol) ok = false; //trailing fields
+
+		if (ok) f(values); else ++malformed;
+		it = eol + 1;
+	}
+
+	return malformed;
+}
+
+//Parse the body concurrently over newline-aligned chunks, concatenating the rows in file order
+template<typename Container, typename Make>
+Container parse_body(const MappedFile& file, const Header& header, std::size_t threads, const std::string& path, Make&& make)
+{
+	const char* first = header.body;
+	const char* last = file.end();
+	const std::size_t size = last - first;
+
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<std::size_t>(1, std::min(threads, size / min_chunk + 1));
+
+	std::vector<const char*> bounds(threads + 1, last);
+	bounds[0] = first;
+	for (std::size_t t = 1; t < threads; ++t)
+	{
+		const char* b = std::max(bounds[t - 1], first + size * t / threads);
+		b = std::find(b, last, '\n');
+		bounds[t] = (b < last) ? b + 1 : last;
+	}
+
+	std::vector<Container> rows(threads);
+	std::vector<std::size_t> malformed(threads, 0);
+
+	auto work = [&](std::size_t t) {
+		//rough estimate of the number of rows to avoid reallocations
+		rows[t].reserve((bounds[t + 1] - bounds[t]) / (8 * header.columns.size()) + 1);
+		malformed[t] = parse_rows(bounds[t], bounds[t + 1], header, [&](const auto& values) { rows[t].emplace_back(make(values)); });
+	};
+
+	std::vector<std::thread> workers;
+	for (std::size_t t = 1; t < threads; ++t) workers.emplace_back(work, t);
+	work(0);
+	for (auto& w : workers) w.join();
+
+	std::size_t n = 0, bad = 0;
+	for (std::size_t t = 0; t < threads; ++t) { n += rows[t].size(); bad += malformed[t]; }
+	if (bad > 0) PRINT_WARN("csv: skipped " << bad << " malformed rows in " << path);
+
+	Container all = std::move(rows[0]);
+	all.reserve(n);
+	for (std::size_t t = 1; t < threads; ++t)
+		all.insert(all.end(), std::make_move_iterator(rows[t].begin()), std::make_move_iterator(rows[t].end()));
+
+	return all;
+}
+
+//Format a number at p, return the position after it
+char* format(char* p, double x)
+{
+#if defined(__cpp_lib_to_chars) //shortest representation reading back to x
+	return std::to_chars(p, p + 32, x).ptr;
+#else
+	return p + std::snprintf(p, 32, "%.17g", x);
+#endif
+}
+char* format(char* p, int x) { return std::to_chars(p, p + 16, x).ptr; }
+
+//Format the rows concurrently in memory, then write them at once
+template<typename Container, typename Format>
+void write_rows(const std::string& path, const char* header, const Container& observations, std::size_t threads, Format&& fmt)
+{
+	const std::size_t n = observations.size();
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<std::size_t>(1, std::min(threads, n / 4096 + 1));
+
+	const std::size_t chunk = (n + threads - 1) / threads;
+	std::vector<std::string> buffers(threads);
+
+	auto work = [&](std::size_t t) {
+		const std::size_t begin = std::min(n, t * chunk), end = std::min(n, begin + chunk);
+		std::string& buffer = buffers[t];
+		buffer.resize((end - begin) * max_row);
+
+		char* p = buffer.data();
+		for (std::size_t i = begin; i < end; ++i) { p = fmt(p, observations[i], i); *p++ = '\n'; }
+		buffer.resize(p - buffer.data());
+	};
+
+	std::vector<std::thread> workers;
+	for (std::size_t t = 1; t < threads; ++t) workers.emplace_back(work, t);
+	work(0);
+	for (auto& w : workers) w.join();
+
+	std::ofstream ofs(path, std::ios::binary);
+	if (not ofs) throw std::runtime_error("csv: cannot write " + path);
+
+	ofs << header << '\n';
+	for (const auto& buffer : buffers) ofs.write(buffer.data(), buffer.size());
+
+	if (not ofs) throw std::runtime_error("csv: cannot write " + path);
+}
+
+BAPObservation feature(const std::array<double, NB_COLUMNS>& values)
+{
+	BAPObservation o;
+	o.k = int(values[K]); o.l = int(values[L]);
+	o.u = values[U]; o.v = values[V];
+	o.rho = values[RHO];
+	o.cluster = int(values[CLUSTER]);
+	o.frame = int(values[FRAME]);
+	return o;
+}
+
+char* format(char* p, const BAPObservation& o)
+{
+	p = format(p, int(o.k)); *p++ = ',';
+	p = format(p, int(o.l)); *p++ = ',';
+	p = format(p, double(o.u)); *p++ = ',';
+	p = format(p, double(o.v)); *p++ = ',';
+	p = format(p, double(o.rho)); *p++ = ',';
+	p = format(p, int(o.cluster)); *p++ = ',';
+	return format(p, int(o.frame));
+}
+
+template<typename Container>
+void append(Container& to, Container&& from)
+{
+	if (to.empty()) { to = std::move(from); return; }
+	to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+}
+
+} //namespace
+
+bool is_csv(const std::string& path)
+{
+	std::string ext = boost::filesystem::path(path).extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+	return ext == ".csv";
+}
+
+Kind kind(const std::string& path)
+{
+	std::ifstream ifs(path);
+	if (not ifs) throw std::runtime_error("csv: cannot open " + path);
+
+	std::string line;
+	std::getline(ifs, line);
+	return parse_header(line.data(), line.data() + line.size()).kind();
+}
+
+void read(const std::string& path, BAPObservations& observations, std::size_t threads)
+{
+	TRACE_SCOPE("compote::csv::read(features)");
+
+	const MappedFile file{path};
+	const Header header = parse_header(file.begin(), file.end());
+
+	for (const int c : {K, L, U, V, RHO, CLUSTER, FRAME})
+		if (not header.has[c]) throw std::runtime_error("csv: missing column '" + std::string(names[c]) + "' in " + path);
+
+	observations = parse_body<BAPObservations>(file, header, threads, path, [](const auto& values) { return feature(values); });
+}
+
+void read(const std::string& path, BAPObservations& observations, Mask& inliers, std::size_t threads)
+{
+	TRACE_SCOPE("compote::csv::read(features, inliers)");
+
+	const MappedFile file{path};
+	const Header header = parse_header(file.begin(), file.end());
+
+	for (const int c : {K, L, U, V, RHO, CLUSTER, FRAME})
+		if (not header.has[c]) throw std::runtime_error("csv: missing column '" + std::string(names[c]) + "' in " + path);
+
+	if (not header.has[INLIER])
+	{
+		observations = parse_body<BAPObservations>(file, header, threads, path, [](const auto& values) { return feature(values); });
+		inliers.assign(observations.size(), 1);
+		return;
+	}
+
+	struct Row { BAPObservation o; std::uint8_t inlier; };
+	const std::vector<Row> rows = parse_body<std::vector<Row>>(file, header, threads, path, [](const auto& values) { 
+		return Row{feature(values), std::uint8_t(values[INLIER] != 0.)}; 
+	});
+
+	observations.clear(); observations.reserve(rows.size());
+	inliers.clear(); inliers.reserve(rows.size());
+	for (const auto& row : rows) { observations.emplace_back(row.o); inliers.emplace_back(row.inlier); }
+}
+
+void read(const std::string& path, MICObservations& observations, std::size_t threads)
+{
+	TRACE_SCOPE("compote::csv::read(centers)");
+
+	const MappedFile file{path};
+	const Header header = parse_header(file.begin(), file.end());
+
+	for (const int c : {K, L, U, V})
+		if (not header.has[c]) throw std::runtime_error("csv: missing column '" + std::string(names[c]) + "' in " + path);
+
+	const bool has_cluster = header.has[CLUSTER];
+	observations = parse_body<MICObservations>(file, header, threads, path, [has_cluster](const auto& values) {
+		MICObservation o;
+		o.k = int(values[K]); o.l = int(values[L]);
+		o.u = values[U]; o.v = values[V];
+		if (has_cluster) o.cluster = int(values[CLUSTER]);
+		return o;
+	});
+}
+
+void write(const std::string& path, const BAPObservations& observations, std::size_t threads)
+{
+	TRACE_SCOPE("compote::csv::write(features)");
+
+	write_rows(path, "k,l,u,v,rho,cluster,frame", observations, threads, [](char* p, const BAPObservation& o, std::size_t) {
+		return format(p, o);
+	});
+}
+
+void write(const std::string& path, const BAPObservations& observations, const Mask& inliers, std::size_t threads)
+{
+	TRACE_SCOPE("compote::csv::write(features, inliers)");
+
+	if (inliers.size() != observations.size()) throw std::runtime_error("csv: inlier mask size mismatch for " + path);
+
+	write_rows(path, "k,l,u,v,rho,cluster,frame,inlier", observations, threads, [&inliers](char* p, const BAPObservation& o, std::size_t i) {
+		p = format(p, o); *p++ = ',';
+		return format(p, int(inliers[i] != 0));
+	});
+}
+
+void write(const std::string& path, const MICObservations& observations, std::size_t threads)
+{
+	TRACE_SCOPE("compote::csv::write(centers)");
+
+	write_rows(path, "k,l,u,v", observations, threads, [](char* p, const MICObservation& o, std::size_t) {
+		p = format(p, int(o.k)); *p++ = ',';
+		p = format(p, int(o.l)); *p++ = ',';
+		p = format(p, double(o.u)); *p++ = ',';
+		return format(p, double(o.v));
+	});
+}
+
+void load(const std::string& paths, ObservationsConfig& cfg, std::size_t threads)
+{
+	std::size_t first = 0;
+	while (first <= paths.size())
+	{
+		std::size_t last = paths.find(',', first);
+		if (last == std::string::npos) last = paths.size();
+		const std::string path = paths.substr(first, last - first);
+		first = last + 1;
+
+		if (path.empty()) continue;
+
+		if (is_csv(path))
+		{
+			switch (kind(path))
+			{
+				case Kind::Features: 
+				{ 
+					BAPObservations obs; Mask inliers; 
+					read(path, obs, inliers, threads); 
+					
+					//features flagged as outliers are dropped
+					std::size_t n = 0;
+					for (std::size_t i = 0; i < obs.size(); ++i) if (inliers[i]) obs[n++] = obs[i];
+					if (n < obs.size()) PRINT_INFO("csv: " << obs.size() - n << " outliers (inlier = 0) dropped from " << path);
+					obs.resize(n);
+					
+					append(cfg.features(), std::move(obs)); 
+					break; 
+				}
+				case Kind::Centers: { MICObservations obs; read(path, obs, threads); append(cfg.centers(), std::move(obs)); break; }
+				default: throw std::runtime_error("csv: unknown header in " + path);
+			}
+		}
+		else
+		{
+			ObservationsConfig other;
+			codec::load(path, other);
+			append(cfg.features(), BAPObservations(other.features()));
+			append(cfg.centers(), MICObservations(other.centers()));
+		}
+	}
+}
+
+} //namespace compote::csv
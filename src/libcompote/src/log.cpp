@@ -0,0 +1,242 @@
+#include "compote/log.h"
+#include "compote/queue.h"
+
+//STD
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace compote::log {
+
+namespace {
+
+using clock = std::chrono::system_clock;
+
+struct Record {
+	clock::time_point time;
+	long tid = 0;
+	int stream = 0; //0 = cout, 1 = cerr
+	std::string text;
+	std::shared_ptr<std::ostream> sink; //nullptr for the original stream
+};
+
+long tid()
+{
+	thread_local const long id = syscall(SYS_gettid);
+	return id;
+}
+
+//File capturing the lines of the calling thread, see Capture
+std::shared_ptr<std::ostream>& sink()
+{
+	thread_local std::shared_ptr<std::ostream> s;
+	return s;
+}
+
+struct Logger {
+	Queue<Record, 4096> queue;
+	std::atomic<std::size_t> submitted{0};
+	std::atomic<std::size_t> written{0};
+	
+	std::atomic<bool> running{false};
+	std::thread thread;
+	
+	std::streambuf* outputs[2] = {nullptr, nullptr}; //original streams
+	std::mutex mtx; //start/stop
+};
+
+Logger& logger() { static Logger l; return l; }
+
+void submit(int stream, std::string&& text)
+{
+	Logger& l = logger();
+	Record r{clock::now(), tid(), stream, std::move(text), sink()};
+	
+	++l.submitted;
+	while (not l.queue.push(std::move(r))) std::this_thread::yield(); //never drop lines
+}
+
+//Lines are accumulated per thread, so that concurrent writers do not interleave characters
+class LineBuffer : public std::streambuf {
+	int stream_;
+	
+	std::string& line() 
+	{ 
+		thread_local std::string lines[2];
+		return lines[stream_]; 
+	}
+	
+protected:
+	int_type overflow(int_type c) override
+	{
+		if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+		
+		std::string& l = line();
+		l.push_back(traits_type::to_char_type(c));
+		if (c == '\n') submit(stream_, std::move(l)), l.clear();
+		return c;
+	}
+	
+	std::streamsize xsputn(const char* s, std::streamsize n) override
+	{
+		std::string& l = line();
+		const char* end = s + n;
+		while (s < end)
+		{
+			const char* nl = static_cast<const char*>(std::memchr(s, '\n', end - s));
+			if (not nl) { l.append(s, end); break; }
+			
+			l.append(s, nl + 1);
+			submit(stream_, std::move(l)); l.clear();
+			s = nl + 1;
+		}
+		return n;
+	}
+	
+	//std::flush and std::endl on std::cout submit the partial line of the calling thread (e.g., a prompt),
+	//without waiting for the writer; std::cerr is flushed after every output operation (unitbuf),
+	//so its partial lines are only submitted by flush()
+	int sync() override
+	{
+		if (stream_ == 0) submit_partial();
+		return 0;
+	}
+	
+public:
+	explicit LineBuffer(int stream) : stream_{stream} {}
+	
+	void submit_partial()
+	{
+		std::string& l = line();
+		if (not l.empty()) submit(stream_, std::move(l)), l.clear();
+	}
+};
+
+//Flushing this buffer waits for the writer, std::cin is tied to it
+class DrainBuffer : public std::streambuf {
+protected:
+	int sync() override { flush(); return 0; }
+};
+
+LineBuffer out_buffer{0}, err_buffer{1};
+DrainBuffer drain_buffer;
+std::ostream drain{&drain_buffer};
+
+void write(const Record& r)
+{
+	Logger& l = logger();
+	
+	const std::time_t t = clock::to_time_t(r.time);
+	const long ms = std::chrono::duration_cast<std::chrono::milliseconds>(r.time.time_since_epoch()).count() % 1000;
+	std::tm tm; localtime_r(&t, &tm);
+	
+	char prefix[64];
+	const int n = std::snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03ld][%ld] ", tm.tm_hour, tm.tm_min, tm.tm_sec, ms, r.tid);
+	
+	if (r.sink) //captured lines are few, flushed one by one so that the file can be followed
+	{
+		r.sink->write(prefix, n).write(r.text.data(), r.text.size());
+		if (r.text.empty() or r.text.back() != '\n') r.sink->put('\n'); //no prompt to keep on the line of a file
+		r.sink->flush();
+		return;
+	}
+	
+	std::streambuf* out = l.outputs[r.stream];
+	out->sputn(prefix, n);
+	out->sputn(r.text.data(), r.text.size());
+}
+
+void loop()
+{
+	Logger& l = logger();
+	Record r;
+	
+	for (;;)
+	{
+		const bool running = l.running.load(std::memory_order_acquire);
+		if (l.queue.pop(r))
+		{
+			write(r);
+			++l.written;
+		}
+		else 
+		{
+			l.outputs[0]->pubsync(); l.outputs[1]->pubsync();
+			if (not running) break;
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	}
+}
+
+} //namespace
+
+void start()
+{
+	Logger& l = logger();
+	std::lock_guard<std::mutex> lock{l.mtx};
+	if (l.running) return;
+	
+	l.outputs[0] = std::cout.rdbuf(&out_buffer);
+	l.outputs[1] = std::cerr.rdbuf(&err_buffer);
+	std::cin.tie(&drain);
+	
+	l.running = true;
+	l.thread = std::thread{loop};
+	
+	static bool registered = false;
+	if (not registered) { std::atexit(stop); registered = true; }
+}
+
+void flush()
+{
+	Logger& l = logger();
+	if (not l.running) return;
+	
+	out_buffer.submit_partial(); err_buffer.submit_partial();
+	const std::size_t target = l.submitted.load();
+	while (l.written.load() < target) std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+void stop()
+{
+	Logger& l = logger();
+	std::lock_guard<std::mutex> lock{l.mtx};
+	if (not l.running) return;
+	
+	out_buffer.submit_partial(); err_buffer.submit_partial(); //partial lines of the calling thread
+	l.running.store(false, std::memory_order_release);
+	l.thread.join();
+	
+	std::cout.rdbuf(l.outputs[0]);
+	std::cerr.rdbuf(l.outputs[1]);
+	std::cin.tie(&std::cout);
+}
+
+Capture::Capture(const std::string& path) : previous_{sink()}
+{
+	auto file = std::make_shared<std::ofstream>(path, std::ios::out | std::ios::trunc);
+	if (not file->is_open()) throw std::runtime_error("log: can not open " + path);
+	
+	out_buffer.submit_partial(); err_buffer.submit_partial(); //lines started before belong to the previous sink
+	sink() = std::move(file);
+}
+
+Capture::~Capture()
+{
+	out_buffer.submit_partial(); err_buffer.submit_partial();
+	sink() = std::move(previous_); //the file is closed once its pending lines are written
+}
+
+} //namespace compote::log
@@ -0,0 +1,192 @@
+#include "compote/lookup.h"
+#include "compote/trace.h"
+
+//STD
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+//BOOST
+#include <boost/filesystem.hpp>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote {
+
+namespace {
+
+constexpr char magic[8] = {'C', 'O', 'M', 'P', 'M', 'I', 'M', '\x1a'};
+constexpr std::uint32_t version = 1;
+
+std::vector<double> signature(const MIA& mia)
+{
+	const P2D a = mia.nodeInWorld(0, 0);
+	const P2D b = mia.nodeInWorld(mia.width() - 1, mia.height() - 1);
+	const P2D c = mia.nodeInWorld(mia.width() - 1, 0);
+	return {a[0], a[1], b[0], b[1], c[0], c[1], mia.diameter()};
+}
+
+} //namespace
+
+MicroImageMap::MicroImageMap(const MIA& mia, std::size_t I, std::size_t cols, std::size_t rows)
+: cols_{cols}, rows_{rows}, width_{mia.width()}, height_{mia.height()}, I_{I}
+{
+	TRACE_SCOPE("compote::MicroImageMap");
+	DEBUG_ASSERT((width_ * height_ < inside_bit), "Too many micro-images to be labelled");
+	
+	labels_.assign(cols_ * rows_, none);
+	types_.resize(width_ * height_);
+	signature_ = signature(mia);
+	
+	std::vector<float> distances(cols_ * rows_, std::numeric_limits<float>::max());
+	
+	const double radius = 0.5 * mia.diameter();
+	const int reach = int(std::ceil(mia.diameter())); //cells are within one pitch of their center
+	
+	for (std::size_t l = 0; l < height_; ++l)
+		for (std::size_t k = 0; k < width_; ++k)
+		{
+			const std::uint32_t i = l * width_ + k;
+			types_[i] = std::uint8_t((I_ > 0) ? mia.type(I_, k, l) : 0);
+			
+			const P2D c = mia.nodeInWorld(k, l);
+			const int u0 = std::max(0, int(c[0]) - reach), u1 = std::min(int(cols_) - 1, int(c[0]) + reach);
+			const int v0 = std::max(0, int(c[1]) - reach), v1 = std::min(int(rows_) - 1, int(c[1]) + reach);
+			
+			for (int v = v0; v <= v1; ++v)
+			{
+				const double dy = v - c[1];
+				for (int u = u0; u <= u1; ++u)
+				{
+					const double dx = u - c[0];
+					const float d = float(std::sqrt(dx * dx + dy * dy));
+					
+					const std::size_t p = std::size_t(v) * cols_ + u;
+					if (d < distances[p]) 
+					{
+						distances[p] = d;
+						labels_[p] = (d <= radius) ? (i | inside_bit) : i;
+					}
+				}
+			}
+		}
+}
+
+void MicroImageMap::lookup(const std::vector<P2D>& points, std::vector<Owner>& owners) const
+{
+	owners.resize(points.size());
+	std::transform(points.begin(), points.end(), owners.begin(), [this](const P2D& p) { return (*this)(p); });
+}
+
+void MicroImageMap::attach(MICObservations& observations) const
+{
+	for (auto& o : observations)
+	{
+		const Owner w = (*this)(P2D{o.u, o.v});
+		o.k = w.k; o.l = w.l;
+	}
+}
+
+void MicroImageMap::attach(BAPObservations& observations) const
+{
+	for (auto& o : observations)
+	{
+		const Owner w = (*this)(P2D{o.u, o.v});
+		o.k = w.k; o.l = w.l;
+	}
+}
+
+bool MicroImageMap::matches(const MIA& mia, std::size_t I, std::size_t cols, std::size_t rows) const
+{
+	if (empty() or cols != cols_ or rows != rows_ or I != I_ or mia.width() != width_ or mia.height() != height_) return false;
+	
+	const std::vector<double> s = signature(mia);
+	for (std::size_t i = 0; i < s.size(); ++i) 
+		if (std::abs(s[i] - signature_[i]) > 1e-9) return false;
+	
+	return true;
+}
+
+//File: magic | version | cols rows width height I (u64) | signature (7 doubles) | types (u8) 
+//      | per row: u32 number of runs, then runs as (u32 length, u32 label)
+void MicroImageMap::save(const std::string& path) const
+{
+	std::ofstream ofs(path, std::ios::binary);
+	auto put = [&ofs](const auto& v) { ofs.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+	
+	ofs.write(magic, sizeof(magic));
+	put(version);
+	for (std::uint64_t v : {cols_, rows_, width_, height_, I_}) put(v);
+	for (double s : signature_) put(s);
+	ofs.write(reinterpret_cast<const char*>(types_.data()), types_.size());
+	
+	std::vector<std::uint32_t> runs;
+	for (std::size_t v = 0; v < rows_; ++v)
+	{
+		runs.clear();
+		const std::uint32_t* row = labels_.data() + v * cols_;
+		for (std::size_t u = 0; u < cols_;)
+		{
+			std::size_t e = u + 1;
+			while (e < cols_ and row[e] == row[u]) ++e;
+			runs.push_back(std::uint32_t(e - u)); runs.push_back(row[u]);
+			u = e;
+		}
+		put(std::uint32_t(runs.size() / 2));
+		ofs.write(reinterpret_cast<const char*>(runs.data()), runs.size() * sizeof(std::uint32_t));
+	}
+}
+
+bool MicroImageMap::load(const std::string& path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (not ifs) return false;
+	
+	auto get = [&ifs](auto& v) { return bool(ifs.read(reinterpret_cast<char*>(&v), sizeof(v))); };
+	
+	char m[sizeof(magic)];
+	std::uint32_t ver;
+	if (not ifs.read(m, sizeof(m)) or std::memcmp(m, magic, sizeof(magic)) != 0 or not get(ver) or ver != version) return false;
+	
+	std::uint64_t h[5];
+	for (auto& v : h) if (not get(v)) return false;
+	cols_ = h[0]; rows_ = h[1]; width_ = h[2]; height_ = h[3]; I_ = h[4];
+	
+	signature_.resize(7);
+	for (auto& s : signature_) if (not get(s)) return false;
+	
+	types_.resize(width_ * height_);
+	if (not ifs.read(reinterpret_cast<char*>(types_.data()), types_.size())) return false;
+	
+	labels_.resize(cols_ * rows_);
+	std::vector<std::uint32_t> runs;
+	for (std::size_t v = 0; v < rows_; ++v)
+	{
+		std::uint32_t n;
+		if (not get(n)) return false;
+		runs.resize(2 * n);
+		if (not ifs.read(reinterpret_cast<char*>(runs.data()), runs.size() * sizeof(std::uint32_t))) return false;
+		
+		std::uint32_t* row = labels_.data() + v * cols_;
+		std::size_t u = 0;
+		for (std::uint32_t r = 0; r < n; ++r)
+		{
+			if (u + runs[2 * r] > cols_) return false;
+			std::fill_n(row + u, runs[2 * r], runs[2 * r + 1]);
+			u += runs[2 * r];
+		}
+		if (u != cols_) return false;
+	}
+	
+	return true;
+}
+
+std::string MicroImageMap::path_for(const std::string& params)
+{
+	return boost::filesystem::path(params).replace_extension(".mimap").string();
+}
+
+} //namespace compote
@@ -0,0 +1,162 @@
+#include "compote/observations.h"
+#include "compote/trace.h"
+
+//STD
+#include <numeric>
+#include <algorithm>
+
+namespace compote {
+
+namespace {
+
+//Counting sort of indices by key in [0, n), stable; returns offsets (n+1) and fills indices
+std::vector<std::uint32_t> counting_sort(const std::vector<std::uint32_t>& keys, std::size_t n, std::vector<std::uint32_t>& indices)
+{
+	std::vector<std::uint32_t> offsets(n + 1, 0);
+	for (const auto key : keys) ++offsets[key + 1];
+	std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+	
+	indices.resize(keys.size());
+	std::vector<std::uint32_t> next(offsets.begin(), offsets.end() - 1);
+	for (std::uint32_t i = 0; i < keys.size(); ++i) indices[next[keys[i]]++] = i;
+	
+	return offsets;
+}
+
+} //namespace
+
+IndexedObservations::IndexedObservations(const BAPObservations& observations)
+{
+	TRACE_SCOPE("compote::IndexedObservations");
+	
+	sources_.resize(observations.size());
+	std::iota(sources_.begin(), sources_.end(), 0u);
+	std::stable_sort(sources_.begin(), sources_.end(), [&observations](std::uint32_t i, std::uint32_t j) {
+		const BAPObservation& a = observations[i]; const BAPObservation& b = observations[j];
+		if (a.frame != b.frame) return a.frame < b.frame;
+		if (a.cluster != b.cluster) return a.cluster < b.cluster;
+		if (a.k != b.k) return a.k < b.k;
+		return a.l < b.l;
+	});
+	
+	observations_.reserve(observations.size());
+	for (const auto i : sources_) observations_.emplace_back(observations[i]);
+	
+	if (observations_.empty()) return;
+	const std::size_t n = observations_.size();
+	
+	//frames and (frame, cluster) groups
+	min_frame_ = observations_.front().frame;
+	const int max_frame = observations_.back().frame;
+	frame_offsets_.assign(std::size_t(max_frame - min_frame_) + 2, 0);
+	cluster_offsets_.assign(frame_offsets_.size(), 0);
+	
+	for (std::uint32_t i = 0; i < n; ++i)
+	{
+		const auto& o = observations_[i];
+		const bool new_frame = (i == 0 or o.frame != observations_[i - 1].frame);
+		if (new_frame or o.cluster != observations_[i - 1].cluster)
+		{
+			clusters_.push_back(o.cluster);
+			group_offsets_.push_back(i);
+		}
+		++frame_offsets_[o.frame - min_frame_ + 1];
+	}
+	group_offsets_.push_back(n);
+	std::partial_sum(frame_offsets_.begin(), frame_offsets_.end(), frame_offsets_.begin());
+	
+	//first group of each frame
+	for (std::size_t f = 0, g = 0; f + 1 < frame_offsets_.size(); ++f)
+	{
+		while (g < clusters_.size() and group_offsets_[g] < frame_offsets_[f]) ++g;
+		cluster_offsets_[f] = g;
+	}
+	cluster_offsets_.back() = clusters_.size();
+	
+	//micro-lenses
+	int max_k = 0, max_l = 0;
+	for (const auto& o : observations_) { max_k = std::max(max_k, o.k); max_l = std::max(max_l, o.l); }
+	lens_width_ = std::size_t(max_k) + 1;
+	
+	const std::size_t nb_lenses = lens_width_ * (std::size_t(max_l) + 1);
+	
+	std::vector<std::uint32_t> keys(n);
+	for (std::uint32_t i = 0; i < n; ++i) //observations without micro-lens go to the last bucket
+		keys[i] = (observations_[i].k < 0 or observations_[i].l < 0) ? nb_lenses : observations_[i].l * lens_width_ + observations_[i].k;
+	lens_offsets_ = counting_sort(keys, nb_lenses + 1, lens_indices_);
+	lens_offsets_.pop_back();
+}
+
+void IndexedObservations::index_types(const MIA& mia, std::size_t I)
+{
+	const std::size_t nb_types = std::max<std::size_t>(I, 1);
+	
+	std::vector<std::uint32_t> keys(observations_.size());
+	for (std::uint32_t i = 0; i < keys.size(); ++i)
+	{
+		const auto& o = observations_[i];
+		if (o.k < 0 or o.l < 0) keys[i] = nb_types; //without micro-lens, last bucket
+		else keys[i] = (I > 1) ? std::uint32_t(mia.type(I, o.k, o.l)) : 0u;
+	}
+	type_offsets_ = counting_sort(keys, nb_types + 1, type_indices_);
+	type_offsets_.pop_back();
+}
+
+std::vector<int> IndexedObservations::frames() const
+{
+	std::vector<int> frames;
+	for (std::size_t f = 0; f + 1 < frame_offsets_.size(); ++f)
+		if (frame_offsets_[f + 1] > frame_offsets_[f]) frames.push_back(int(f) + min_frame_);
+	return frames;
+}
+
+Range<BAPObservation> IndexedObservations::frame(int f) const
+{
+	if (not has_frame(f)) return {};
+	const std::size_t i = f - min_frame_;
+	return range(frame_offsets_[i], frame_offsets_[i + 1]);
+}
+
+std::size_t IndexedObservations::nb_clusters(int f) const
+{
+	if (not has_frame(f)) return 0;
+	const std::size_t i = f - min_frame_;
+	return cluster_offsets_[i + 1] - cluster_offsets_[i];
+}
+
+Range<BAPObservation> IndexedObservations::cluster(int f, std::size_t c) const
+{
+	if (c >= nb_clusters(f)) return {};
+	const std::size_t g = cluster_offsets_[f - min_frame_] + c;
+	return range(group_offsets_[g], group_offsets_[g + 1]);
+}
+
+Range<BAPObservation> IndexedObservations::frame_cluster(int f, int cluster) const
+{
+	if (not has_frame(f)) return {};
+	const std::size_t i = f - min_frame_;
+	
+	//clusters of a frame are sorted
+	const auto first = clusters_.begin() + cluster_offsets_[i], last = clusters_.begin() + cluster_offsets_[i + 1];
+	const auto it = std::lower_bound(first, last, cluster);
+	if (it == last or *it != cluster) return {};
+	
+	const std::size_t g = it - clusters_.begin();
+	return range(group_offsets_[g], group_offsets_[g + 1]);
+}
+
+IndexedRange<BAPObservation> IndexedObservations::lens(int k, int l) const
+{
+	if (k < 0 or l < 0 or std::size_t(k) >= lens_width_) return {};
+	const std::size_t key = std::size_t(l) * lens_width_ + k;
+	if (key + 1 >= lens_offsets_.size()) return {};
+	return indexed(lens_indices_, lens_offsets_[key], lens_offsets_[key + 1]);
+}
+
+IndexedRange<BAPObservation> IndexedObservations::type(int t) const
+{
+	if (t < 0 or std::size_t(t) + 1 >= type_offsets_.size()) return {};
+	return indexed(type_indices_, type_offsets_[t], type_offsets_[t + 1]);
+}
+
+} //namespace compote
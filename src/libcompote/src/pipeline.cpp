@@ -0,0 +1,302 @@
+#include "compote/pipeline.h"
+#include "compote/trace.h"
+
+//OPENCV
+#include <opencv2/opencv.hpp>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+#include <pleno/processing/precalibration/preprocess.h>
+#include <pleno/processing/detection/detection.h>
+#include <pleno/processing/imgproc/improcess.h> //devignetting
+
+namespace compote {
+
+void load(const ImagesConfig& cfg, Images& images, bool whites, bool checkerboards)
+{
+	TRACE_SCOPE("compote::load");
+	DEBUG_ASSERT((cfg.meta().rgb()), "Images must be in rgb format.");
+	DEBUG_ASSERT((cfg.meta().format() < 16), "Floating-point images not supported.");
+	
+	images.format = cfg.meta().format();
+	
+	if (whites) ::load(cfg.whites(), images.whites, cfg.meta().debayered());
+	if (checkerboards)
+	{
+		::load(cfg.checkerboards(), images.checkerboards, cfg.meta().debayered());
+		
+		ImageWithInfo mask;
+		::load(cfg.mask(), mask, cfg.meta().debayered());
+		images.mask = mask.img;
+	}
+}
+
+LazyImages::LazyImages(const ImagesConfig& cfg) : cfg_{cfg}, available_{true}
+{
+	DEBUG_ASSERT((cfg_.meta().rgb()), "Images must be in rgb format.");
+	DEBUG_ASSERT((cfg_.meta().format() < 16), "Floating-point images not supported.");
+	
+	images_.format = cfg_.meta().format();
+}
+
+const std::vector<ImageWithInfo>& LazyImages::whites()
+{
+	DEBUG_ASSERT((available_), "No images configuration available to load white images");
+	if (not whites_)
+	{
+		TRACE_SCOPE("compote::LazyImages::whites");
+		::load(cfg_.whites(), images_.whites, cfg_.meta().debayered());
+		whites_ = true;
+		
+		DEBUG_ASSERT((images_.whites.size() != 0u), "You need to provide white images!");
+	}
+	return images_.whites;
+}
+
+const std::vector<ImageWithInfo>& LazyImages::checkerboards()
+{
+	DEBUG_ASSERT((available_), "No images configuration available to load checkerboard images");
+	if (not checkerboards_)
+	{
+		TRACE_SCOPE("compote::LazyImages::checkerboards");
+		::load(cfg_.checkerboards(), images_.checkerboards, cfg_.meta().debayered());
+		checkerboards_ = true;
+		
+		DEBUG_ASSERT((images_.checkerboards.size() != 0u), "You need to provide checkerboard images!");
+		
+		const double cbfnbr = images_.checkerboards[0].fnumber;	
+		for (const auto& [ _ , fnumber, __ ] : images_.checkerboards)
+		{
+			DEBUG_ASSERT((cbfnbr == fnumber), "All checkerboard images should have the same aperture configuration");
+		}
+		
+		ImageWithInfo mask;
+		::load(cfg_.mask(), mask, cfg_.meta().debayered());
+		DEBUG_ASSERT((mask.fnumber == cbfnbr), "No corresponding f-number between mask and images");
+		images_.mask = mask.img;
+	}
+	return images_.checkerboards;
+}
+
+const Image& LazyImages::mask()
+{
+	checkerboards();
+	return images_.mask;
+}
+
+InternalParameters precalibrate(
+	MIA& mia, 
+	const std::vector<ImageWithInfo>& whites, 
+	const PlenopticCameraConfig& cfg_camera
+)
+{
+	DEBUG_ASSERT((whites.size() != 0u), "You need to provide white images to pre-calibrate!");
+	TRACE_SCOPE("compote::precalibrate");
+	
+	MICObservations mic_obs;
+	for(const auto& [img, fnumber, __] : whites)
+	{
+		if(fnumber <= cfg_camera.main_lens().aperture() and cfg_camera.mode() != PlenopticCamera::Mode::Unfocused) continue; //micro-images are overlapping
+		
+		MICObservations obs = detection_mic(img, cfg_camera.I());
+		mic_obs.insert(std::end(mic_obs), std::begin(obs), std::end(obs));
+	}
+	calibration_MIA(mia, mic_obs);
+	
+	const Sensor sensor{cfg_camera.sensor()};
+	return preprocess(whites, mia, sensor.scale(), cfg_camera.I(), cfg_camera.mode(), cfg_camera.main_lens().aperture());
+}
+
+Image devignette(const Image& img, const Image& mask, std::size_t format)
+{
+	Image unvignetted;
+	if (format == 8u) devignetting(img, mask, unvignetted);
+	else /* if (format == 16u) */ devignetting_u16(img, mask, unvignetted);
+	
+	return unvignetted;
+}
+
+BAPObservations detect_features(
+	const Images& images, 
+	const MIA& mia, 
+	const InternalParameters& params
+)
+{
+	compote::trace::Scope scope{"compote::detect_features"};
+	BAPObservations bap_obs;
+	
+	std::size_t f_ = 0;
+	for (const auto& [ img, _, frame ] : images.checkerboards)
+	{		
+		const std::size_t f = (frame != -1) ? frame : f_;
+		
+		BAPObservations bapf = detection_bapfeatures(devignette(img, images.mask, images.format), mia, params);
+		std::for_each(bapf.begin(), bapf.end(), [&f](BAPObservation& cbo) { cbo.frame = f; });
+		TRACE_COUNTER("bap observations per frame", bapf.size());
+		
+		bap_obs.insert(std::end(bap_obs), 
+			std::make_move_iterator(std::begin(bapf)),
+			std::make_move_iterator(std::end(bapf))
+		);
+		++f_;
+	}
+	scope.arg("bap observations", bap_obs.size());
+	
+	return bap_obs;
+}
+
+MICObservations detect_centers(const Image& white, std::size_t I)
+{
+	TRACE_SCOPE("compote::detect_centers");
+	return detection_mic(white, I);
+}
+
+IndexedImages pictures(const Images& images)
+{
+	TRACE_SCOPE("compote::pictures");
+	IndexedImages pictures;
+	
+	std::size_t f_ = 0;
+	for (const auto& [ raw, _, frame ] : images.checkerboards)
+	{
+		const std::size_t f = (frame != -1) ? frame : f_; //same indexing as detect_features
+		
+		const Image unvignetted = devignette(raw, images.mask, images.format);
+		
+		Image img = Image::zeros(unvignetted.rows, unvignetted.cols, CV_8UC1);
+		cv::cvtColor(unvignetted, img, cv::COLOR_BGR2GRAY);
+		pictures.emplace(f, img);
+		++f_;
+	}
+	
+	return pictures;
+}
+
+PlenopticCamera initial_camera(
+	const PlenopticCameraConfig& cfg_camera, 
+	const MIA& mia, 
+	const InternalParameters& params
+)
+{
+	const Sensor sensor{cfg_camera.sensor()};
+	
+	const double F = cfg_camera.main_lens().f();
+	const double N = cfg_camera.main_lens().aperture();
+	const double h = cfg_camera.dist_focus();
+	const PlenopticCamera::Mode mode = (cfg_camera.mode() != -1) ? PlenopticCamera::Mode(cfg_camera.mode()) : PlenopticCamera::Mode::Galilean;
+	
+	PlenopticCamera mfpc;
+	mfpc.init(sensor, mia, params, F, N, h, mode);
+	
+	return mfpc;
+}
+
+void calibrate(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const Options& options
+)
+{
+	if (not options.schedule.empty())
+	{
+		calibrate_coarse_to_fine(poses, mfpc, scene, features, centers, pictures, options.schedule);
+	}
+	else
+	{
+		compote::trace::Scope scope{"calibration_PlenopticCamera"};
+		scope.arg("bap observations", features.size());
+		scope.arg("center observations", centers.size());
+		calibration_PlenopticCamera(poses, mfpc, scene, features, centers, pictures);
+	}
+	
+	postcalibrate(poses, mfpc, scene, features, pictures, options);
+}
+
+void postcalibrate(
+	const CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures,
+	const Options& options
+)
+{
+	if (options.invdistortion)
+	{
+		CheckerBoards boards; boards.reserve(poses.size());
+		for (const auto& [p, f] : poses)
+		{
+			scene.pose() = p;
+			boards.emplace_back(scene);		
+		}
+		
+		Distortions invdistortions;
+		TRACE_SCOPE("calibration_inverseDistortions");
+		calibration_inverseDistortions(invdistortions, mfpc, boards);
+		mfpc.main_lens_invdistortions() = invdistortions;
+	}
+	
+	if (options.blur and mfpc.multifocus() and not pictures.empty())
+	{
+		TRACE_SCOPE("calibration_relativeBlur");
+		calibration_relativeBlur(mfpc.params(), features, pictures);
+	}
+}
+
+void extrinsics(
+	CalibrationPoses& poses,
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures
+)
+{
+	compote::trace::Scope scope{"calibration_ExtrinsicsPlenopticCamera"};
+	scope.arg("bap observations", features.size());
+	calibration_ExtrinsicsPlenopticCamera(poses, mfpc, scene, features, pictures);
+}
+
+Calibration calibrate(
+	const Images& images,
+	const PlenopticCameraConfig& cfg_camera,
+	const CheckerBoard& scene,
+	const InternalParameters* params,
+	const BAPObservations* features,
+	const MICObservations* centers,
+	const Options& options
+)
+{
+	Calibration calib;
+	MIA mia{cfg_camera.mia()};
+	
+	if (params) calib.params = *params;
+	else calib.params = precalibrate(mia, images.whites, cfg_camera);
+	
+	if (features) calib.features = *features;
+	else calib.features = detect_features(images, mia, calib.params);
+	
+	if (centers and centers->size() > 0u) calib.centers = *centers;
+	else 
+	{
+		DEBUG_ASSERT((images.whites.size() > 1u), "No centers available and no white images to compute them");
+		calib.centers = detect_centers(images.whites[1].img, cfg_camera.I());
+	}
+	
+	DEBUG_ASSERT(
+		((calib.features.size() > 0u) and (calib.centers.size() > 0u)), 
+		"No observations available (missing features or centers)"
+	);
+	
+	calib.camera = initial_camera(cfg_camera, mia, calib.params);
+	calibrate(calib.poses, calib.camera, scene, calib.features, calib.centers, pictures(images), options);
+	calib.params = calib.camera.params();
+	
+	return calib;
+}
+
+} //namespace compote
@@ -0,0 +1,184 @@
+#include "compote/render.h"
+#include "compote/queue.h"
+
+//STD
+#include <atomic>
+#include <cctype>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <iomanip>
+#include <sstream>
+
+//OPENCV
+#include <opencv2/opencv.hpp>
+
+//BOOST
+#include <boost/filesystem.hpp>
+
+//LIBPLENO
+#include <pleno/graphic/gui.h>
+#include <pleno/graphic/viewer_2d.h>
+
+#include <pleno/io/printer.h>
+
+namespace compote::render {
+
+namespace {
+
+//Bound of the memory held by the pending overlays (raw images may weigh tens of MB each)
+constexpr std::size_t kMaxPendingBytes = std::size_t(256) << 20;
+
+std::size_t bytes(const Overlay& o) { return o.image.total() * o.image.elemSize() + o.points.size() * sizeof(P2D); }
+
+struct Renderer {
+	Queue<Overlay, 256> queue;
+	std::atomic<std::size_t> pending{0}; //bytes held by the queued overlays
+	std::atomic<Mode> mode{Mode::Off};
+	std::atomic<bool> running{false};
+	std::atomic<std::size_t> dropped{0};
+	std::mutex mutex; //wakes up the render thread
+	std::condition_variable cv;
+	bool signaled = false;
+	std::size_t count = 0; //overlays written in headless mode
+	std::string directory;
+	std::thread thread;
+};
+
+Renderer& renderer() { static Renderer r; return r; }
+
+//Background with the points drawn on it, as a 8-bit BGR image
+cv::Mat compose(const Overlay& o)
+{
+	static const cv::Scalar bgr[] = { {255, 0, 0}, {0, 255, 0}, {255, 0, 255} };
+	
+	cv::Mat canvas;
+	if (not o.image.empty())
+	{
+		cv::Mat img8u;
+		if (o.image.depth() == CV_16U) o.image.convertTo(img8u, CV_8U, 255. / 65535.);
+		else if (o.image.depth() == CV_8U) img8u = o.image;
+		else cv::normalize(o.image, img8u, 0, 255, cv::NORM_MINMAX, CV_8U);
+		
+		if (img8u.channels() == 1) cv::cvtColor(img8u, canvas, cv::COLOR_GRAY2BGR);
+		else canvas = img8u.clone();
+	}
+	else
+	{
+		double w = 1., h = 1.;
+		for (const auto& p : o.points) { w = std::max(w, p[0] + 1.); h = std::max(h, p[1] + 1.); }
+		canvas = cv::Mat::zeros(int(h), int(w), CV_8UC3);
+	}
+	
+	const cv::Scalar color = bgr[std::size_t(o.color)];
+	for (const auto& p : o.points)
+		cv::circle(canvas, cv::Point2d{p[0], p[1]}, std::max(1, o.width / 2), color, -1);
+	
+	return canvas;
+}
+
+//The points are rasterized on the background, so that the viewer draws a single image per overlay
+//instead of one primitive per point
+void draw_viewer(const Overlay& o)
+{
+	const Image canvas = compose(o);
+	RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).name(o.name), canvas);
+	Viewer::update();
+}
+
+void draw_headless(const Overlay& o, Renderer& r)
+{
+	const cv::Mat canvas = compose(o);
+	
+	std::string name = o.name;
+	std::replace_if(name.begin(), name.end(), [](char c) { return not std::isalnum(c) and c != '-' and c != '_'; }, '_');
+	
+	std::ostringstream path;
+	path << r.directory << "/" << std::setw(4) << std::setfill('0') << r.count++ << "-" << name << ".png";
+	cv::imwrite(path.str(), canvas);
+}
+
+//Headless rendering thread, woken up by submit() and stop()
+void loop()
+{
+	Renderer& r = renderer();
+	Overlay o;
+	
+	for (;;)
+	{
+		while (r.queue.pop(o))
+		{
+			draw_headless(o, r);
+			r.pending -= bytes(o);
+			o = Overlay{}; //release the image
+		}
+		
+		std::unique_lock<std::mutex> lock{r.mutex};
+		r.cv.wait(lock, [&r]() { return r.signaled or not r.running; });
+		if (not r.signaled) break; //stopped and drained
+		r.signaled = false;
+	}
+}
+
+} //namespace
+
+void start(Mode mode, const std::string& directory)
+{
+	Renderer& r = renderer();
+	if (r.running or mode == Mode::Off) return;
+	
+	if (mode == Mode::Headless)
+	{
+		r.directory = (directory == "") ? "." : directory;
+		boost::filesystem::create_directories(r.directory);
+	}
+	
+	r.mode = mode;
+	r.running = true;
+	//the viewer is not thread-safe: it is drawn by the thread submitting, which also draws with libpleno
+	if (mode == Mode::Headless) r.thread = std::thread{loop};
+}
+
+void stop()
+{
+	Renderer& r = renderer();
+	if (not r.running) return;
+	
+	{
+		std::lock_guard<std::mutex> lock{r.mutex};
+		r.running = false;
+	}
+	r.cv.notify_one();
+	if (r.thread.joinable()) r.thread.join();
+	r.mode = Mode::Off;
+	
+	if (r.dropped > 0) PRINT_WARN("render: " << r.dropped << " overlays dropped (queue full or over " << (kMaxPendingBytes >> 20) << " MB)");
+}
+
+Mode mode() { return renderer().mode.load(std::memory_order_relaxed); }
+
+void submit(Overlay&& overlay)
+{
+	Renderer& r = renderer();
+	if (not r.running.load(std::memory_order_relaxed)) return;
+	
+	if (r.mode == Mode::Viewer) { draw_viewer(overlay); return; }
+	
+	//an overlay is dropped if the queue is full or if it would exceed the memory bound (unless the queue is empty)
+	const std::size_t n = bytes(overlay);
+	const std::size_t held = r.pending.fetch_add(n);
+	if ((held > 0 and held + n > kMaxPendingBytes) or not r.queue.push(std::move(overlay))) 
+	{ 
+		r.pending -= n; ++r.dropped; 
+		return; 
+	}
+	{
+		std::lock_guard<std::mutex> lock{r.mutex};
+		r.signaled = true;
+	}
+	r.cv.notify_one();
+}
+
+} //namespace compote::render
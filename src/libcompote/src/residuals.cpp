@@ -0,0 +1,329 @@
+#include "compote/residuals.h"
+
+//STD
+#include <cmath>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+//BOOST
+#include <boost/filesystem.hpp>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote {
+
+void Residuals::resize(std::size_t n)
+{
+	index.resize(n); frame.resize(n); k.resize(n); l.resize(n); type.resize(n); zone.resize(n);
+	u.resize(n); v.resize(n); du.resize(n); dv.resize(n); drho.resize(n);
+}
+
+namespace {
+
+//Split [0,n) over threads, each thread working on a contiguous chunk
+template<typename F>
+void parallel_chunks(std::size_t n, std::size_t threads, F&& f)
+{
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<std::size_t>(1, std::min(threads, n / 1024 + 1));
+	
+	const std::size_t chunk = (n + threads - 1) / threads;
+	
+	std::vector<std::thread> workers;
+	for (std::size_t t = 0; t < threads; ++t)
+	{
+		const std::size_t begin = t * chunk, end = std::min(n, begin + chunk);
+		if (begin >= end) break;
+		workers.emplace_back([&f, t, begin, end]() { f(t, begin, end); });
+	}
+	for (auto& w : workers) w.join();
+}
+
+//Keep valid rows only
+void compact(Residuals& r, const std::vector<char>& valid)
+{
+	std::size_t j = 0;
+	for (std::size_t i = 0; i < valid.size(); ++i)
+	{
+		if (not valid[i]) continue;
+		r.index[j] = r.index[i]; r.frame[j] = r.frame[i]; r.k[j] = r.k[i]; r.l[j] = r.l[i]; r.type[j] = r.type[i]; r.zone[j] = r.zone[i];
+		r.u[j] = r.u[i]; r.v[j] = r.v[i]; r.du[j] = r.du[i]; r.dv[j] = r.dv[i]; r.drho[j] = r.drho[i];
+		++j;
+	}
+	r.invalid = valid.size() - j;
+	r.resize(j);
+}
+
+//Radial zone of a pixel, the sensor geometry being computed once
+struct Zones {
+	double cu, cv, rmax;
+	std::size_t n;
+	
+	Zones(const PlenopticCamera& mfpc, std::size_t zones) 
+	: cu{0.5 * mfpc.sensor().width()}, cv{0.5 * mfpc.sensor().height()}, rmax{std::hypot(cu, cv)}, n{zones} {}
+	
+	int operator()(double u, double v) const { return std::min(int(n) - 1, int(std::hypot(u - cu, v - cv) / rmax * n)); }
+};
+
+//Checkerboard corners in the camera frame, as used by the residuals analytics (not by libpleno's solvers,
+//whose costs are evaluated by libpleno): each corner of a frame is seen in many micro-images, so that it is
+//transformed once per (frame, corner). Only the pose transform is memoized, the main-lens projection
+//stays inside PlenopticCamera::project, run for each observation.
+class FrameCorners {
+	const PlenopticCamera& mfpc_;
+	CheckerBoard board_;
+	std::vector<P3D> corners_;
+	std::vector<std::size_t> stamps_; //a corner is valid for the frame of the same stamp
+	std::size_t stamp_ = 0;
+	
+public:
+	FrameCorners(const PlenopticCamera& mfpc, const CheckerBoard& board) 
+	: mfpc_{mfpc}, board_{board}, corners_(board.nbNodes()), stamps_(board.nbNodes(), 0) {}
+	
+	void frame(const Pose& pose) { board_.pose() = pose; ++stamp_; }
+	bool contains(int cluster) const { return cluster >= 0 and std::size_t(cluster) < corners_.size(); }
+	
+	const P3D& operator[](int cluster)
+	{
+		if (stamps_[cluster] != stamp_)
+		{
+			corners_[cluster] = to_coordinate_system_of(mfpc_.pose(), board_.nodeInWorld(cluster));
+			stamps_[cluster] = stamp_;
+		}
+		return corners_[cluster];
+	}
+};
+
+//Type of micro-lens (k,l), constant for I <= 1
+int micro_lens_type(const MIA& mia, std::size_t I, int k, int l) { return (I <= 1) ? 0 : mia.type(I, k, l); }
+
+//BAP residuals of observations [begin, end)
+void bap_kernel(
+	const PlenopticCamera& mfpc, const CheckerBoard& board, const std::map<int, Pose>& frames, 
+	const BAPObservations& observations, const Zones& zones,
+	std::size_t begin, std::size_t end, Residuals& r, std::vector<char>& valid
+)
+{
+	const MIA& mia = mfpc.mia();
+	const std::size_t I = mfpc.I();
+	int current = -1;
+	FrameCorners corners{mfpc, board};
+	
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const auto& o = observations[i];
+		
+		if (o.frame != current) 
+		{
+			const auto it = frames.find(o.frame);
+			if (it == frames.end()) continue;
+			corners.frame(it->second); current = o.frame;
+		}
+		
+		if (not corners.contains(o.cluster)) continue;
+		
+		P3D bap;
+		if (not mfpc.project(corners[o.cluster], o.k, o.l, bap)) continue;
+		
+		r.index[i] = int(i); r.frame[i] = o.frame; r.k[i] = o.k; r.l[i] = o.l;
+		r.type[i] = micro_lens_type(mia, I, o.k, o.l);
+		r.zone[i] = zones(o.u, o.v);
+		r.u[i] = o.u; r.v[i] = o.v;
+		r.du[i] = bap[0] - o.u; r.dv[i] = bap[1] - o.v; r.drho[i] = bap[2] - o.rho;
+		valid[i] = 1;
+	}
+}
+
+void center_kernel(
+	const PlenopticCamera& mfpc, const MICObservations& observations, const Zones& zones,
+	std::size_t begin, std::size_t end, Residuals& r, std::vector<char>& valid
+)
+{
+	const MIA& mia = mfpc.mia();
+	const std::size_t I = mfpc.I();
+	const int width = mia.width(), height = mia.height();
+	
+	for (std::size_t i = begin; i < end; ++i)
+	{
+		const auto& o = observations[i];
+		if (o.k < 0 or o.l < 0 or o.k >= width or o.l >= height) continue;
+		
+		const P2D c = mia.nodeInWorld(o.k, o.l);
+		
+		r.index[i] = int(i); r.frame[i] = -1; r.k[i] = o.k; r.l[i] = o.l;
+		r.type[i] = micro_lens_type(mia, I, o.k, o.l);
+		r.zone[i] = zones(o.u, o.v);
+		r.u[i] = o.u; r.v[i] = o.v;
+		r.du[i] = c[0] - o.u; r.dv[i] = c[1] - o.v; r.drho[i] = 0.;
+		valid[i] = 1;
+	}
+}
+
+} //namespace
+
+Residuals bap_residuals(
+	const PlenopticCamera& mfpc, 
+	const CheckerBoard& scene, 
+	const CalibrationPoses& poses, 
+	const BAPObservations& observations,
+	const ResidualsOptions& options
+)
+{
+	std::map<int, Pose> frames;
+	for (const auto& [p, f] : poses) frames[f] = p;
+	
+	Residuals r; r.resize(observations.size());
+	std::vector<char> valid(observations.size(), 0);
+	const Zones zones{mfpc, options.zones};
+	
+	parallel_chunks(observations.size(), options.threads, [&](std::size_t, std::size_t begin, std::size_t end) {
+		bap_kernel(mfpc, scene, frames, observations, zones, begin, end, r, valid);
+	});
+	
+	compact(r, valid);
+	return r;
+}
+
+Residuals center_residuals(
+	const PlenopticCamera& mfpc, 
+	const MICObservations& observations,
+	const ResidualsOptions& options
+)
+{
+	Residuals r; r.resize(observations.size());
+	std::vector<char> valid(observations.size(), 0);
+	const Zones zones{mfpc, options.zones};
+	
+	parallel_chunks(observations.size(), options.threads, [&](std::size_t, std::size_t begin, std::size_t end) {
+		center_kernel(mfpc, observations, zones, begin, end, r, valid);
+	});
+	
+	compact(r, valid);
+	return r;
+}
+
+void ErrorStats::add(double e, double erho, const ResidualsOptions& options)
+{
+	if (not std::isfinite(e) or not std::isfinite(erho)) return;
+	if (histogram.empty()) histogram.assign(options.bins, 0u);
+	
+	++n; sum += e; sumsq += e * e; max = std::max(max, e);
+	sumsq_rho += erho * erho;
+	
+	if (options.bins == 0 or not (options.max > 0.)) return;
+	
+	//clamped before the conversion, which is undefined out of the range of size_t
+	const double x = e / options.max * options.bins;
+	const std::size_t bin = (x >= double(options.bins - 1)) ? options.bins - 1 : std::size_t(std::max(0., x));
+	++histogram[bin];
+}
+
+void ErrorStats::merge(const ErrorStats& other)
+{
+	if (histogram.empty()) histogram.assign(other.histogram.size(), 0u);
+	
+	n += other.n; sum += other.sum; sumsq += other.sumsq; max = std::max(max, other.max);
+	sumsq_rho += other.sumsq_rho;
+	for (std::size_t b = 0; b < other.histogram.size(); ++b) histogram[b] += other.histogram[b];
+}
+
+double ErrorStats::rmse() const { return (n > 0) ? std::sqrt(sumsq / n) : 0.; }
+double ErrorStats::rmse_rho() const { return (n > 0) ? std::sqrt(sumsq_rho / n) : 0.; }
+
+ResidualsReport aggregate(const Residuals& residuals, const ResidualsOptions& options)
+{
+	const std::size_t threads = (options.threads == 0) ? std::max(1u, std::thread::hardware_concurrency()) : options.threads;
+	std::vector<ResidualsReport> partials(threads);
+	
+	parallel_chunks(residuals.size(), threads, [&](std::size_t t, std::size_t begin, std::size_t end) {
+		ResidualsReport& report = partials[t];
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const double e = std::hypot(residuals.du[i], residuals.dv[i]);
+			const double erho = residuals.drho[i];
+			
+			report.all.add(e, erho, options);
+			report.frames[residuals.frame[i]].add(e, erho, options);
+			report.types[residuals.type[i]].add(e, erho, options);
+			report.zones[residuals.zone[i]].add(e, erho, options);
+		}
+	});
+	
+	ResidualsReport report;
+	report.invalid = residuals.invalid;
+	for (const auto& p : partials)
+	{
+		report.all.merge(p.all);
+		for (const auto& [f, s] : p.frames) report.frames[f].merge(s);
+		for (const auto& [t, s] : p.types) report.types[t].merge(s);
+		for (const auto& [z, s] : p.zones) report.zones[z].merge(s);
+	}
+	
+	return report;
+}
+
+namespace {
+
+void write_stats(std::ostream& os, const ErrorStats& s)
+{
+	os << "{\"n\": " << s.n << ", \"mean\": " << s.mean() << ", \"rmse\": " << s.rmse() 
+		<< ", \"max\": " << s.max << ", \"rmse_rho\": " << s.rmse_rho() << ", \"histogram\": [";
+	for (std::size_t b = 0; b < s.histogram.size(); ++b) os << (b ? ", " : "") << s.histogram[b];
+	os << "]}";
+}
+
+void write_group(std::ostream& os, const std::string& name, const std::map<int, ErrorStats>& group, const std::string& indent)
+{
+	os << indent << "\t\"" << name << "\": {";
+	std::size_t i = 0;
+	for (const auto& [key, s] : group)
+	{
+		os << (i++ ? ",\n" : "\n") << indent << "\t\t\"" << key << "\": ";
+		write_stats(os, s);
+	}
+	os << "\n" << indent << "\t}";
+}
+
+} //namespace
+
+void write_json(std::ostream& os, const ResidualsReport& report, const ResidualsOptions& options, const std::string& indent)
+{
+	os.precision(9);
+	os << "{\n" << indent << "\t\"histogram_range\": [0, " << options.max << "], \"invalid\": " << report.invalid << ",\n";
+	os << indent << "\t\"all\": "; write_stats(os, report.all); os << ",\n";
+	write_group(os, "frames", report.frames, indent); os << ",\n";
+	write_group(os, "types", report.types, indent); os << ",\n";
+	write_group(os, "zones", report.zones, indent); os << "\n";
+	os << indent << "}";
+}
+
+void save_columns(const std::string& directory, const Residuals& residuals)
+{
+	namespace fs = boost::filesystem;
+	fs::create_directories(directory);
+	
+	std::ofstream schema((fs::path(directory) / "columns.json").string());
+	schema << "{\"rows\": " << residuals.size() << ", \"columns\": [";
+	
+	std::size_t c = 0;
+	auto column = [&](const std::string& name, const auto& values) {
+		using T = typename std::decay_t<decltype(values)>::value_type;
+		const std::string ext = std::is_same_v<T, int> ? ".i32" : ".f64";
+		
+		std::ofstream ofs((fs::path(directory) / (name + ext)).string(), std::ios::binary);
+		ofs.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+		
+		schema << (c++ ? ", " : "") << "{\"name\": \"" << name << "\", \"type\": \"" << (std::is_same_v<T, int> ? "int32" : "float64") << "\"}";
+	};
+	
+	static_assert(sizeof(int) == 4, "int32 columns expected");
+	column("index", residuals.index); column("frame", residuals.frame); column("k", residuals.k); column("l", residuals.l);
+	column("type", residuals.type); column("zone", residuals.zone);
+	column("u", residuals.u); column("v", residuals.v);
+	column("du", residuals.du); column("dv", residuals.dv); column("drho", residuals.drho);
+	
+	schema << "]}\n";
+}
+
+} //namespace compote
@@ -0,0 +1,259 @@
+#include "compote/robust.h"
+#include "compote/schedule.h"
+#include "compote/telemetry.h"
+#include "compote/trace.h"
+
+//STD
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote {
+
+const char* to_string(Loss loss)
+{
+	switch (loss)
+	{
+		case Loss::Huber: return "huber";
+		case Loss::Cauchy: return "cauchy";
+		default: return "squared";
+	}
+}
+
+Loss parse_loss(const std::string& name)
+{
+	if (name == "" or name == "squared") return Loss::Squared;
+	if (name == "huber") return Loss::Huber;
+	if (name == "cauchy") return Loss::Cauchy;
+	throw std::runtime_error("robust: unknown loss '" + name + "' (squared, huber, cauchy)");
+}
+
+double weight(Loss loss, double e, double c)
+{
+	e = std::abs(e);
+	switch (loss)
+	{
+		case Loss::Huber: return (e <= c) ? 1. : c / e;
+		case Loss::Cauchy: return 1. / (1. + (e / c) * (e / c));
+		default: return 1.;
+	}
+}
+
+namespace {
+
+double median(std::vector<double>& values)
+{
+	const std::size_t n = values.size();
+	std::nth_element(values.begin(), values.begin() + n / 2, values.end());
+	const double upper = values[n / 2];
+	if (n % 2) return upper;
+	return 0.5 * (upper + *std::max_element(values.begin(), values.begin() + n / 2));
+}
+
+std::vector<double> errors(const Residuals& r)
+{
+	std::vector<double> e(r.size());
+	for (std::size_t i = 0; i < r.size(); ++i) e[i] = std::hypot(r.du[i], r.dv[i]);
+	return e;
+}
+
+//Scale of the loss from the robust standard deviation of the errors
+double loss_scale(Loss loss, double sigma)
+{
+	return ((loss == Loss::Cauchy) ? 2.385 : 1.345) * sigma;
+}
+
+} //namespace
+
+double robust_sigma(std::vector<double> errors)
+{
+	if (errors.empty()) return 0.;
+	
+	const double m = median(errors);
+	for (double& e : errors) e = std::abs(e - m);
+	return 1.4826 * median(errors);
+}
+
+Mask flag_outliers(
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const CalibrationPoses& poses,
+	const BAPObservations& features,
+	const RobustOptions& options
+)
+{
+	TRACE_SCOPE("compote::flag_outliers");
+	
+	Mask inliers(features.size(), 1);
+	if (options.threshold <= 0.) return inliers;
+	
+	//residuals of the observations sorted by frame: the rows of a frame are contiguous
+	const IndexedObservations indexed{features};
+	const Residuals r = bap_residuals(mfpc, scene, poses, indexed.observations(), options.residuals);
+	const std::vector<double> e = errors(r);
+	
+	std::size_t outliers = 0, frames = 0;
+	for (std::size_t first = 0, last = 0; first < r.size(); first = last)
+	{
+		const int f = r.frame[first];
+		while (last < r.size() and r.frame[last] == f) ++last;
+		++frames;
+		
+		const std::size_t rows = last - first;
+		if (rows < options.min_frame) continue;
+		
+		std::vector<double> values(e.begin() + first, e.begin() + last);
+		
+		const double sigma = robust_sigma(values);
+		if (sigma <= 0.) continue;
+		const double limit = median(values) + options.threshold * sigma;
+		
+		std::size_t n = 0;
+		for (std::size_t i = first; i < last; ++i) if (e[i] > limit) { inliers[indexed.source(r.index[i])] = 0; ++n; }
+		outliers += n;
+		
+		PRINT_DEBUG("Frame " << f << ": " << n << " outliers out of " << rows << " (error > " << limit << " pix)");
+	}
+	
+	PRINT_INFO("Outliers: " << outliers << " out of " << features.size() << " features (" << frames << " frames)");
+	return inliers;
+}
+
+Mask prepass(
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const IndexedImages& pictures,
+	const RobustOptions& options
+)
+{
+	if (options.threshold <= 0.) return Mask(features.size(), 1);
+	
+	const BAPObservations subset = (options.fraction > 0. and options.fraction < 1.) ? decimate(features, mfpc, options.fraction) : features;
+	
+	telemetry::Solve solve{"prepass", {{"observations", double(subset.size())}}};
+	CalibrationPoses poses;
+	{
+		compote::trace::Scope scope{"compote::prepass (extrinsics)"};
+		scope.arg("bap observations", subset.size());
+		calibration_ExtrinsicsPlenopticCamera(poses, mfpc, scene, subset, pictures);
+	}
+	
+	const Mask inliers = flag_outliers(mfpc, scene, poses, features, options);
+	solve.close({{"observations", double(features.size())}, {"inliers", double(count(inliers))}});
+	return inliers;
+}
+
+BAPObservations select(const BAPObservations& features, const Mask& inliers)
+{
+	BAPObservations selected;
+	selected.reserve(count(inliers));
+	for (std::size_t i = 0; i < features.size() and i < inliers.size(); ++i)
+		if (inliers[i]) selected.emplace_back(features[i]);
+	return selected;
+}
+
+std::size_t count(const Mask& inliers)
+{
+	return std::count_if(inliers.begin(), inliers.end(), [](std::uint8_t m) { return m != 0; });
+}
+
+BAPObservations pseudo_observations(
+	const PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const CalibrationPoses& poses,
+	const BAPObservations& features,
+	Loss loss, double scale,
+	const ResidualsOptions& options
+)
+{
+	BAPObservations pseudo = features;
+	if (loss == Loss::Squared) return pseudo;
+	
+	const Residuals r = bap_residuals(mfpc, scene, poses, features, options);
+	if (scale <= 0.) scale = loss_scale(loss, robust_sigma(errors(r)));
+	if (scale <= 0.) return pseudo;
+	
+	for (std::size_t i = 0; i < r.size(); ++i)
+	{
+		const double w = weight(loss, std::hypot(r.du[i], r.dv[i]), scale);
+		if (w >= 1.) continue;
+		
+		//o* = p + w (o - p), with p = o + d
+		auto& o = pseudo[r.index[i]];
+		o.u += (1. - w) * r.du[i];
+		o.v += (1. - w) * r.dv[i];
+		o.rho += (1. - w) * r.drho[i];
+	}
+	
+	return pseudo;
+}
+
+AnytimeReport irls(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	const CheckerBoard& scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const RobustOptions& options,
+	const Budget& budget,
+	const AnytimeReport& previous,
+	const StageCallback& on_round
+)
+{
+	AnytimeReport report;
+	if (options.loss == Loss::Squared) return report;
+	
+	//time per observation of the previous solves, then of the rounds
+	double seconds = 0.; std::size_t observations = 0;
+	for (const auto& stage : previous.stages) { seconds += stage.seconds; observations += stage.observations; }
+	
+	for (std::size_t round = 0; round < options.rounds; ++round)
+	{
+		const std::size_t n = features.size() + centers.size();
+		const double predicted = (observations > 0) ? seconds * n / observations : 0.;
+		if (budget.expired() or predicted > budget.remaining())
+		{
+			PRINT_WARN("Budget: stopping IRLS before round " << round << " (" << budget.elapsed() << " s elapsed, " 
+				<< predicted << " s predicted, " << budget.remaining() << " s remaining)");
+			report.reason = StopReason::Budget;
+			report.skipped = options.rounds - round;
+			break;
+		}
+		
+		const BAPObservations pseudo = pseudo_observations(mfpc, scene, poses, features, options.loss, options.scale, options.residuals);
+		
+		telemetry::Solve solve{"irls", {{"round", double(round)}, {"observations", double(pseudo.size() + centers.size())}}};
+		const auto start = Budget::clock::now();
+		{
+			compote::trace::Scope scope{"calibration_PlenopticCamera (irls)"};
+			scope.arg("round", round);
+			scope.arg("bap observations", pseudo.size());
+			
+			PRINT_INFO("=== IRLS round " << round << " (" << to_string(options.loss) << ")");
+			CalibrationPoses estimated = poses; //the round starts from the current poses
+			calibration_PlenopticCamera(estimated, mfpc, scene, pseudo, centers, pictures);
+			poses = std::move(estimated);
+		}
+		const double elapsed = std::chrono::duration<double>(Budget::clock::now() - start).count();
+		seconds += elapsed; observations += n;
+		
+		const double cost = aggregate(bap_residuals(mfpc, scene, poses, features, options.residuals), options.residuals).all.rmse();
+		report.stages.push_back(StageStats{"irls-" + std::to_string(round), 1., n, elapsed, cost});
+		PRINT_INFO("=== IRLS round " << round << ": rmse = " << cost << " (" << elapsed << " s)");
+		solve.close({{"round", double(round)}, {"cost", cost}, {"observations", double(pseudo.size())}});
+		
+		if (on_round) on_round(mfpc, poses, report);
+	}
+	
+	report.cost = report.stages.empty() ? previous.cost : report.stages.back().cost;
+	report.seconds = budget.elapsed();
+	return report;
+}
+
+} //namespace compote
@@ -0,0 +1,159 @@
+#include "compote/schedule.h"
+#include "compote/anytime.h"
+
+//STD
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+#include <tuple>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote {
+
+namespace {
+
+//Radial zone of a pixel, from the sensor center to its corners
+struct Zones {
+	double cu, cv, rmax;
+	std::size_t n;
+	
+	Zones(double width, double height, std::size_t zones) 
+	: cu{0.5 * width}, cv{0.5 * height}, rmax{std::max(1e-9, std::hypot(cu, cv))}, n{std::max<std::size_t>(1, zones)} {}
+	Zones(const PlenopticCamera& mfpc, std::size_t zones) : Zones{double(mfpc.sensor().width()), double(mfpc.sensor().height()), zones} {}
+	
+	int operator()(double u, double v) const { return std::min(int(n) - 1, int(std::hypot(u - cu, v - cv) / rmax * n)); }
+};
+
+std::uint64_t mix(std::uint64_t x)
+{
+	//splitmix64 finalizer
+	x += 0x9e3779b97f4a7c15ull;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	return x ^ (x >> 31);
+}
+
+std::uint64_t hash(int frame, int cluster, int k, int l)
+{
+	std::uint64_t h = mix(std::uint32_t(frame));
+	h = mix(h ^ std::uint32_t(cluster));
+	h = mix(h ^ std::uint32_t(k));
+	return mix(h ^ std::uint32_t(l));
+}
+
+//Keep ceil(fraction * n) observations of each stratum, the ones of lowest rank
+template<typename Observations, typename Stratum, typename Rank>
+Observations select(const Observations& observations, double fraction, Stratum&& stratum, Rank&& rank)
+{
+	if (fraction >= 1.) return observations;
+	
+	using Key = std::tuple<int, int, int, std::uint64_t>;
+	std::vector<Key> keys(observations.size());
+	for (std::size_t i = 0; i < observations.size(); ++i)
+	{
+		const auto [a, b, c] = stratum(observations[i]);
+		keys[i] = Key{a, b, c, rank(observations[i])};
+	}
+	
+	std::vector<std::uint32_t> order(observations.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&keys](auto i, auto j) { return keys[i] < keys[j]; });
+	
+	std::vector<char> keep(observations.size(), 0);
+	for (std::size_t begin = 0; begin < order.size(); )
+	{
+		const auto& key = keys[order[begin]];
+		std::size_t end = begin + 1;
+		while (end < order.size() and std::get<0>(keys[order[end]]) == std::get<0>(key) 
+			and std::get<1>(keys[order[end]]) == std::get<1>(key) and std::get<2>(keys[order[end]]) == std::get<2>(key)) ++end;
+		
+		const std::size_t n = std::size_t(std::ceil(fraction * (end - begin)));
+		for (std::size_t i = begin; i < begin + n; ++i) keep[order[i]] = 1;
+		
+		begin = end;
+	}
+	
+	Observations subset; subset.reserve(std::count(keep.begin(), keep.end(), 1));
+	for (std::size_t i = 0; i < observations.size(); ++i) if (keep[i]) subset.emplace_back(observations[i]);
+	
+	return subset;
+}
+
+} //namespace
+
+std::vector<double> Schedule::stages() const
+{
+	std::vector<double> stages;
+	for (const double f : fractions) if (f > 0. and f < 1.) stages.emplace_back(f);
+	stages.emplace_back(1.);
+	return stages;
+}
+
+Schedule Schedule::parse(const std::string& fractions)
+{
+	Schedule schedule;
+	
+	std::istringstream iss{fractions};
+	std::string token;
+	while (std::getline(iss, token, ','))
+	{
+		std::istringstream value{token};
+		double f = 0.;
+		if ((value >> f) and f > 0. and f < 1.) schedule.fractions.emplace_back(f);
+		else if (f == 1.) continue; //the last stage always uses every observation
+		else if (token.find_first_not_of(" \t") != std::string::npos) PRINT_WARN("Ignoring fraction of observations = " << token);
+	}
+	std::sort(schedule.fractions.begin(), schedule.fractions.end());
+	schedule.fractions.erase(std::unique(schedule.fractions.begin(), schedule.fractions.end()), schedule.fractions.end());
+	
+	return schedule;
+}
+
+Schedule Schedule::anytime()
+{
+	Schedule schedule;
+	schedule.fractions = {0.1, 0.3};
+	return schedule;
+}
+
+BAPObservations decimate(const BAPObservations& observations, const PlenopticCamera& mfpc, double fraction, std::size_t zones)
+{
+	const Zones zone{mfpc, zones};
+	return select(observations, fraction,
+		[&zone](const BAPObservation& o) { return std::make_tuple(int(o.frame), int(o.cluster), zone(o.u, o.v)); },
+		[](const BAPObservation& o) { return hash(o.frame, o.cluster, o.k, o.l); }
+	);
+}
+
+MICObservations decimate(const MICObservations& observations, const PlenopticCamera& mfpc, double fraction, std::size_t zones)
+{
+	return decimate(observations, mfpc.sensor().width(), mfpc.sensor().height(), fraction, zones);
+}
+
+MICObservations decimate(const MICObservations& observations, std::size_t width, std::size_t height, double fraction, std::size_t zones)
+{
+	const Zones zone{double(width), double(height), zones};
+	return select(observations, fraction,
+		[&zone](const MICObservation& o) { return std::make_tuple(int(o.cluster), zone(o.u, o.v), 0); },
+		[](const MICObservation& o) { return hash(-1, o.cluster, o.k, o.l); }
+	);
+}
+
+void calibrate_coarse_to_fine(
+	CalibrationPoses& poses,
+	PlenopticCamera& mfpc,
+	CheckerBoard scene,
+	const BAPObservations& features,
+	const MICObservations& centers,
+	const IndexedImages& pictures,
+	const Schedule& schedule
+)
+{
+	calibrate_anytime(poses, mfpc, scene, features, centers, pictures, schedule, Budget{});
+}
+
+} //namespace compote
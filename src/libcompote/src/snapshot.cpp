@@ -0,0 +1,350 @@
+#include "compote/snapshot.h"
+#include "compote/codec.h"
+
+//STD
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+//BOOST
+#include <boost/filesystem.hpp>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace fs = boost::filesystem;
+
+namespace compote::snapshot {
+
+namespace {
+
+constexpr char magic[8] = {'C', 'O', 'M', 'P', 'O', 'T', 'E', '\x1a'};
+
+enum Tag : std::uint32_t { Camera = 1, Params = 2, MIA_ = 3, Poses = 4, Progress_ = 5 };
+
+template<typename T> struct is_vector : std::false_type {};
+template<typename T, typename A> struct is_vector<std::vector<T, A>> : std::true_type {};
+
+//Binary writer of compote's own sections, fields are visited with operator()
+struct Writer {
+	std::string buffer;
+	
+	void raw(const void* data, std::size_t n) { buffer.append(static_cast<const char*>(data), n); }
+	
+	template<typename T>
+	void operator()(const T& value)
+	{
+		if constexpr (std::is_arithmetic_v<T>) raw(&value, sizeof(T));
+		else /* if constexpr (is_vector<T>::value) */
+		{
+			static_assert(is_vector<T>::value, "snapshot: unsupported field");
+			const std::uint64_t n = value.size(); raw(&n, sizeof(n));
+			for (const auto& v : value) (*this)(v);
+		}
+	}
+};
+
+//Binary reader, same visitation order as the writer
+struct Reader {
+	const char* it;
+	const char* end;
+	
+	void raw(void* data, std::size_t n) 
+	{
+		if (std::size_t(end - it) < n) throw std::runtime_error("snapshot: truncated section");
+		std::memcpy(data, it, n); it += n;
+	}
+	
+	template<typename T>
+	void operator()(T& value)
+	{
+		if constexpr (std::is_arithmetic_v<T>) raw(&value, sizeof(T));
+		else /* if constexpr (is_vector<T>::value) */
+		{
+			static_assert(is_vector<T>::value, "snapshot: unsupported field");
+			std::uint64_t n; raw(&n, sizeof(n));
+			if (n > std::uint64_t(end - it)) throw std::runtime_error("snapshot: truncated section");
+			value.resize(n);
+			for (auto& v : value) (*this)(v);
+		}
+	}
+};
+
+template<typename Archive>
+void fields(Archive& a, Progress& p)
+{
+	a(p.fractions); a(p.features); a(p.centers); a(p.observations); a(p.seconds); a(p.costs);
+}
+
+//Memory-backed file where libpleno writes (resp. reads) its archives, libpleno only serializing to paths;
+//one file is reused by all the sections of a snapshot
+class Scratch {
+	std::string path_;
+	
+public:
+	Scratch() : path_{(fs::path(codec::detail::scratch()) / fs::unique_path("compote-%%%%-%%%%-%%%%.bin")).string()} {}
+	~Scratch() { codec::detail::remove(path_); }
+	
+	Scratch(const Scratch&) = delete;
+	Scratch& operator=(const Scratch&) = delete;
+	
+	const std::string& path() const { return path_; }
+};
+
+//libpleno's own binary archive of a configuration, as the bytes v::save writes in a .bin file
+template<typename Cfg>
+std::string archive(Cfg cfg, const Scratch& scratch)
+{
+	if constexpr (std::is_same_v<Cfg, InternalParameters>) v::save(scratch.path(), v::make_serializable(&cfg));
+	else v::save(scratch.path(), cfg);
+	
+	std::ifstream ifs(scratch.path(), std::ios::binary);
+	std::string bytes(std::size_t(fs::file_size(scratch.path())), '\0');
+	if (not ifs.read(bytes.data(), bytes.size())) throw std::runtime_error("snapshot: cannot read " + scratch.path());
+	
+	return bytes;
+}
+
+template<typename Cfg>
+Cfg unarchive(const char* data, std::size_t size, const Scratch& scratch)
+{
+	{
+		std::ofstream ofs(scratch.path(), std::ios::binary | std::ios::trunc);
+		ofs.write(data, size);
+		if (not ofs) throw std::runtime_error("snapshot: cannot write " + scratch.path());
+	}
+	
+	Cfg cfg;
+	if constexpr (std::is_same_v<Cfg, InternalParameters>) v::load(scratch.path(), v::make_serializable(&cfg));
+	else v::load(scratch.path(), cfg);
+	
+	return cfg;
+}
+
+void write_section(std::ofstream& ofs, Tag tag, const std::string& payload)
+{
+	const std::uint32_t t = tag; const std::uint64_t size = payload.size();
+	ofs.write(reinterpret_cast<const char*>(&t), sizeof(t));
+	ofs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	ofs.write(payload.data(), size);
+}
+
+std::string payload(const Progress& progress)
+{
+	Writer w;
+	fields(w, const_cast<Progress&>(progress)); //the writer does not modify the fields
+	return w.buffer;
+}
+
+Progress read_progress(const char* data, std::size_t size)
+{
+	Progress progress;
+	Reader r{data, data + size};
+	fields(r, progress);
+	return progress;
+}
+
+//Flush a file (or a directory, for the entries renamed in it) to the storage device
+bool sync(const std::string& path, int flags = O_RDONLY)
+{
+	const int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+	if (fd < 0) return false;
+	const bool synced = (::fsync(fd) == 0);
+	::close(fd);
+	return synced;
+}
+
+} //namespace
+
+bool is_snapshot(const std::string& path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	char m[sizeof(magic)] = {};
+	return ifs.read(m, sizeof(m)) and std::memcmp(m, magic, sizeof(magic)) == 0;
+}
+
+void save(const std::string& path, const Snapshot& snapshot)
+{
+	const std::string tmp = path + ".tmp";
+	std::ofstream ofs(tmp, std::ios::binary);
+	if (not ofs) throw std::runtime_error("snapshot: cannot write " + tmp);
+	
+	const std::uint32_t n = bool(snapshot.camera) + bool(snapshot.params) + bool(snapshot.mia) + bool(snapshot.poses) + bool(snapshot.progress);
+	ofs.write(magic, sizeof(magic));
+	ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	ofs.write(reinterpret_cast<const char*>(&n), sizeof(n));
+	
+	const Scratch scratch;
+	if (snapshot.camera) write_section(ofs, Camera, archive(*snapshot.camera, scratch));
+	if (snapshot.params) write_section(ofs, Params, archive(*snapshot.params, scratch));
+	if (snapshot.mia) write_section(ofs, MIA_, archive(*snapshot.mia, scratch));
+	if (snapshot.poses) write_section(ofs, Poses, archive(*snapshot.poses, scratch));
+	if (snapshot.progress) write_section(ofs, Progress_, payload(*snapshot.progress));
+	
+	ofs.close();
+	if (not ofs or not sync(tmp)) { std::remove(tmp.c_str()); throw std::runtime_error("snapshot: cannot write " + tmp); }
+	if (std::rename(tmp.c_str(), path.c_str()) != 0) { std::remove(tmp.c_str()); throw std::runtime_error("snapshot: cannot rename " + tmp + " to " + path); }
+	
+	//the rename is only durable once the directory is
+	const fs::path dir = fs::absolute(path).parent_path();
+	if (not sync(dir.string(), O_RDONLY | O_DIRECTORY)) PRINT_WARN("snapshot: cannot sync directory " << dir.string());
+}
+
+Snapshot load(const std::string& path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (not ifs) throw std::runtime_error("snapshot: cannot read " + path);
+	
+	std::ostringstream oss; oss << ifs.rdbuf();
+	const std::string data = oss.str();
+	
+	Reader r{data.data(), data.data() + data.size()};
+	
+	char m[sizeof(magic)];
+	r.raw(m, sizeof(m));
+	if (std::memcmp(m, magic, sizeof(magic)) != 0) throw std::runtime_error("snapshot: " + path + " is not a snapshot");
+	
+	std::uint32_t v, n;
+	r(v); r(n);
+	if (v != version) throw std::runtime_error("snapshot: unsupported version " + std::to_string(v) + " (expected " + std::to_string(version) + ")");
+	
+	Snapshot snapshot;
+	const Scratch scratch;
+	for (std::uint32_t s = 0; s < n; ++s)
+	{
+		std::uint32_t tag; std::uint64_t size;
+		r(tag); r(size);
+		if (std::uint64_t(r.end - r.it) < size) throw std::runtime_error("snapshot: truncated file " + path);
+		
+		switch (tag)
+		{
+			case Camera: snapshot.camera = unarchive<PlenopticCameraConfig>(r.it, size, scratch); break;
+			case Params: snapshot.params = unarchive<InternalParameters>(r.it, size, scratch); break;
+			case MIA_: snapshot.mia = unarchive<MIAConfig>(r.it, size, scratch); break;
+			case Poses: snapshot.poses = unarchive<CalibrationPosesConfig>(r.it, size, scratch); break;
+			case Progress_: snapshot.progress = read_progress(r.it, size); break;
+			default: PRINT_WARN("snapshot: unknown section " << tag << " skipped"); break;
+		}
+		r.it += size;
+	}
+	
+	return snapshot;
+}
+
+PlenopticCamera camera(const PlenopticCameraConfig& cfg)
+{
+	PlenopticCamera mfpc;
+	
+	mfpc.mode() = (cfg.mode() != -1) ? PlenopticCamera::Mode(cfg.mode()) : PlenopticCamera::Mode::Galilean; //as initial_camera
+	mfpc.I() = cfg.I();
+	mfpc.dist_focus() = cfg.dist_focus();
+	
+	mfpc.sensor() = Sensor{cfg.sensor()};
+	mfpc.mia() = MIA{cfg.mia()};
+	mfpc.mla() = MLA{cfg.mla()};
+	mfpc.main_lens() = ThinLensCamera{cfg.main_lens()};
+	mfpc.main_lens_distortions() = cfg.distortions();
+	mfpc.main_lens_invdistortions() = cfg.distortions_inverse();
+	
+	return mfpc;
+}
+
+PlenopticCameraConfig config(const PlenopticCamera& mfpc)
+{
+	//libpleno builds the configuration when saving, round-trip through a memory-backed binary file (lossless)
+	const Scratch scratch;
+	
+	PlenopticCameraConfig cfg;
+	::save(scratch.path(), mfpc); 
+	v::load(scratch.path(), cfg);
+	
+	return cfg;
+}
+
+CalibrationPosesConfig config(const CalibrationPoses& poses)
+{
+	CalibrationPosesConfig cfg;
+	cfg.poses().resize(poses.size());
+	
+	std::size_t i = 0;
+	for (const auto& [p, f] : poses)
+	{
+		cfg.poses()[i].pose() = p;
+		cfg.poses()[i].frame() = f;
+		++i;
+	}
+	return cfg;
+}
+
+CalibrationPoses poses(const CalibrationPosesConfig& cfg)
+{
+	CalibrationPoses poses;
+	poses.reserve(cfg.poses().size());
+	for (const auto& cfg_pose : cfg.poses()) 
+		poses.emplace_back(CalibrationPose{cfg_pose.pose(), cfg_pose.frame()});
+	return poses;
+}
+
+void load(const std::string& path, PlenopticCamera& mfpc)
+{
+	if (not is_snapshot(path)) { ::load(path, mfpc); return; }
+	
+	const Snapshot snapshot = load(path);
+	DEBUG_ASSERT((snapshot.camera.has_value()), "No camera in snapshot");
+	
+	mfpc = camera(*snapshot.camera);
+	if (snapshot.params) mfpc.params() = *snapshot.params;
+}
+
+void load(const std::string& camera, const std::string& params, PlenopticCamera& mfpc)
+{
+	load(camera, mfpc);
+	if (params == "" or params == camera) return;
+	
+	if (is_snapshot(params))
+	{
+		const Snapshot snapshot = load(params);
+		DEBUG_ASSERT((snapshot.params.has_value()), "No internal parameters in snapshot");
+		mfpc.params() = *snapshot.params;
+	}
+	else
+	{
+		InternalParameters p;
+		v::load(params, v::make_serializable(&p));
+		mfpc.params() = p;
+	}
+}
+
+Snapshot from_json(const std::string& camera, const std::string& params, const std::string& mia, const std::string& poses)
+{
+	Snapshot snapshot;
+	if (camera != "") { snapshot.camera.emplace(); v::load(camera, *snapshot.camera); }
+	if (params != "") { snapshot.params.emplace(); v::load(params, v::make_serializable(&*snapshot.params)); }
+	if (mia != "") { PlenopticCameraConfig cfg; v::load(mia, cfg); snapshot.mia = cfg.mia(); }
+	if (poses != "") { snapshot.poses.emplace(); v::load(poses, *snapshot.poses); }
+	
+	return snapshot;
+}
+
+void to_json(const Snapshot& snapshot, const std::string& camera, const std::string& params, const std::string& mia, const std::string& poses)
+{
+	if (camera != "" and snapshot.camera) v::save(camera, *snapshot.camera);
+	if (params != "" and snapshot.params) 
+	{
+		InternalParameters p = *snapshot.params;
+		v::save(params, v::make_serializable(&p));
+	}
+	if (mia != "" and snapshot.mia) 
+	{
+		PlenopticCameraConfig cfg; cfg.mia() = *snapshot.mia;
+		v::save(mia, cfg);
+	}
+	if (poses != "" and snapshot.poses) v::save(poses, *snapshot.poses);
+}
+
+} //namespace compote::snapshot
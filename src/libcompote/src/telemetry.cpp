@@ -0,0 +1,164 @@
+#include "compote/telemetry.h"
+
+//STD
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote::telemetry {
+
+namespace {
+
+std::atomic<bool> enabled_{false};
+std::mutex mtx;
+std::ofstream file;
+int socket_ = -1;
+double period_ = 0.;
+
+const auto origin = std::chrono::steady_clock::now();
+
+double now() //s
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+}
+
+std::string escape(const std::string& s)
+{
+	std::string e; e.reserve(s.size());
+	for (char c : s)
+	{
+		if (c == '"' or c == '\\') { e += '\\'; e += c; }
+		else if (c == '\t' or c == '\n') e += ' ';
+		else e += c;
+	}
+	return e;
+}
+
+int connect_unix(const std::string& path)
+{
+	sockaddr_un addr{};
+	if (path.size() >= sizeof(addr.sun_path)) return -1;
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+	
+	const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) return -1;
+	if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) { ::close(fd); return -1; }
+	return fd;
+}
+
+void write(const std::string& line)
+{
+	std::lock_guard<std::mutex> lock{mtx};
+	if (socket_ >= 0)
+	{
+		std::size_t sent = 0;
+		while (sent < line.size())
+		{
+			const ssize_t n = ::send(socket_, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+			if (n <= 0)
+			{
+				PRINT_WARN("telemetry: socket closed, telemetry disabled");
+				::close(socket_); socket_ = -1; enabled_ = false;
+				return;
+			}
+			sent += n;
+		}
+	}
+	else if (file)
+	{
+		file << line << std::flush;
+	}
+}
+
+} //namespace
+
+void enable(const std::string& target, double period)
+{
+	std::lock_guard<std::mutex> lock{mtx};
+	if (target.rfind("unix:", 0) == 0)
+	{
+		const std::string path = target.substr(5);
+		socket_ = connect_unix(path);
+		if (socket_ < 0) { PRINT_ERR("telemetry: can not connect to " << path << ", telemetry disabled"); return; }
+	}
+	else
+	{
+		file.open(target, std::ios::out | std::ios::app);
+		if (not file) { PRINT_ERR("telemetry: can not write " << target << ", telemetry disabled"); return; }
+	}
+	
+	period_ = period;
+	enabled_ = true;
+}
+
+bool enabled() { return enabled_; }
+
+void emit(const std::string& solver, const std::string& event, const Fields& fields)
+{
+	if (not enabled()) return;
+	
+	std::ostringstream oss;
+	oss << std::setprecision(9);
+	oss << "{\"t\": " << now() << ", \"solver\": \"" << escape(solver) << "\", \"event\": \"" << escape(event) << "\"";
+	for (const auto& [key, value] : fields)
+	{
+		oss << ", \"" << escape(key) << "\": ";
+		if (std::isfinite(value)) oss << value; else oss << "null";
+	}
+	oss << "}\n";
+	
+	write(oss.str());
+}
+
+Solve::Solve(std::string solver, const Fields& fields) : solver_{std::move(solver)}, start_{now()}
+{
+	if (not enabled()) return;
+	
+	emit(solver_, "start", fields);
+	if (period_ <= 0.) return;
+	
+	const double period = period_;
+	heartbeat_ = std::thread([this, period]() {
+		std::unique_lock<std::mutex> lock{mutex_};
+		while (not cv_.wait_for(lock, std::chrono::duration<double>(period), [this]() { return closed_; }))
+			emit(solver_, "running", {{"elapsed", now() - start_}});
+	});
+}
+
+Solve::~Solve()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		closed_ = true;
+	}
+	cv_.notify_all();
+	if (heartbeat_.joinable()) heartbeat_.join();
+}
+
+void Solve::close(const Fields& fields)
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		if (closed_) return;
+		closed_ = true;
+	}
+	cv_.notify_all();
+	if (heartbeat_.joinable()) heartbeat_.join();
+	
+	Fields f = fields;
+	f.emplace_back("seconds", now() - start_);
+	emit(solver_, "end", f);
+}
+
+} //namespace compote::telemetry
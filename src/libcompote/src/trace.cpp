@@ -0,0 +1,171 @@
+#include "compote/trace.h"
+
+//STD
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+namespace compote::trace {
+
+namespace {
+
+std::atomic<bool> enabled_{false};
+std::mutex mtx;
+std::string path_;
+std::vector<std::string> events;
+
+const auto origin = std::chrono::steady_clock::now();
+
+double now() //us
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+}
+
+double cputime() //us
+{
+	timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+double peak_rss() //MB
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.;
+}
+
+long tid()
+{
+	return syscall(SYS_gettid);
+}
+
+std::string escape(const std::string& s)
+{
+	std::string e; e.reserve(s.size());
+	for (char c : s)
+	{
+		if (c == '"' or c == '\\') { e += '\\'; e += c; }
+		else if (c == '\t' or c == '\n') e += ' ';
+		else e += c;
+	}
+	return e;
+}
+
+void record(std::string event)
+{
+	std::lock_guard<std::mutex> lock{mtx};
+	events.emplace_back(std::move(event));
+}
+
+thread_local std::unique_ptr<Scope> current_step;
+
+void write()
+{
+	std::lock_guard<std::mutex> lock{mtx};
+	std::ofstream ofs(path_);
+	if (not ofs)
+	{
+		PRINT_ERR("Can not write trace file (" << path_ << ")");
+		return;
+	}
+	
+	ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (std::size_t i = 0; i < events.size(); ++i)
+		ofs << events[i] << (i + 1 < events.size() ? ",\n" : "\n");
+	ofs << "]}\n";
+}
+
+} //namespace
+
+void enable(const std::string& path)
+{
+	{
+		std::lock_guard<std::mutex> lock{mtx};
+		path_ = path;
+	}
+	enabled_ = true;
+	std::atexit(write);
+}
+
+bool enabled() { return enabled_; }
+
+void flush()
+{
+	if (not enabled_) return;
+	current_step.reset();
+	write();
+}
+
+void counter(const std::string& name, double value)
+{
+	if (not enabled_) return;
+	
+	std::ostringstream oss; oss << std::setprecision(12);
+	oss << "{\"name\":\"" << escape(name) << "\",\"ph\":\"C\",\"ts\":" << now()
+		<< ",\"pid\":" << getpid() << ",\"tid\":" << tid()
+		<< ",\"args\":{\"value\":" << value << "}}";
+	
+	record(oss.str());
+}
+
+Scope::Scope(std::string name) : name_{std::move(name)}
+{
+	if (not enabled_) return;
+	
+	active_ = true;
+	ts_ = now();
+	cpu_ = cputime();
+}
+
+Scope::~Scope() { close(); }
+
+void Scope::arg(const std::string& key, double value)
+{
+	if (active_) args_.emplace_back(key, value);
+}
+
+void Scope::close()
+{
+	if (not active_) return;
+	active_ = false;
+	
+	const double dur = now() - ts_;
+	const double cpu = cputime() - cpu_;
+	
+	std::ostringstream oss; oss << std::setprecision(12);
+	oss << "{\"name\":\"" << escape(name_) << "\",\"cat\":\"compote\",\"ph\":\"X\",\"ts\":" << ts_ << ",\"dur\":" << dur
+		<< ",\"pid\":" << getpid() << ",\"tid\":" << tid()
+		<< ",\"args\":{\"cpu_ms\":" << cpu * 1e-3 << ",\"peak_rss_mb\":" << peak_rss();
+	for (const auto& [key, value] : args_) oss << ",\"" << escape(key) << "\":" << value;
+	oss << "}}";
+	
+	record(oss.str());
+}
+
+void step(const std::string& name)
+{
+	if (not enabled_) return;
+	
+	current_step.reset();
+	current_step = std::make_unique<Scope>(name);
+}
+
+void step_arg(const std::string& key, double value)
+{
+	if (current_step) current_step->arg(key, value);
+}
+
+} //namespace compote::trace
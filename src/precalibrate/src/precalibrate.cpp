@@ -33,6 +33,13 @@
 
 #include <pleno/io/images.h>
 
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/telemetry.h>
+#include <compote/render.h>
+#include <compote/lookup.h>
+#include <compote/anytime.h>
+
 #include "utils.h"
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -46,10 +53,17 @@ int main(int argc, char* argv[])
 	
 	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
 	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
+	if (config.path.telemetry != "") compote::telemetry::enable(config.path.telemetry);
+	
+	if (config.use_gui) compote::render::start(compote::render::Mode::Viewer);
+	else if (config.path.overlays != "") compote::render::start(compote::render::Mode::Headless, config.path.overlays);
 
 ////////////////////////////////////////////////////////////////////////////////
 // 1) Load white images from configuration file
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("1) Load white images");
 	PRINT_WARN("1) Load white images from configuration file");
 	ImagesConfig cfg_images;
 	v::load(config.path.images, cfg_images);
@@ -64,6 +78,9 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 2) Load Camera information from configuration file
 ////////////////////////////////////////////////////////////////////////////////	
+	compote::trace::step_arg("images", whites.size());
+	
+	TRACE_STEP("2) Load camera");
 	PRINT_WARN("2) Load Camera information from configuration file");
 	PlenopticCameraConfig cfg_camera;
 	v::load(config.path.camera, cfg_camera);
@@ -81,6 +98,7 @@ int main(int argc, char* argv[])
 ////////////////////////////////////////////////////////////////////////////////
 // 3) Grid Parameters calibration
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("3) MIA calibration");
 	PRINT_WARN("3) MIA geometry Parameters calibration");
 	//3.1) Compute micro-image centers
 	PRINT_WARN("\t3.1) Compute micro-image centers");
@@ -91,28 +109,47 @@ int main(int argc, char* argv[])
 		if(fnumber <= cfg_camera.main_lens().aperture() and cfg_camera.mode() != PlenopticCamera::Mode::Unfocused) continue; //micro-images are overlapping
 		
 		PRINT_INFO("=== Computing MIC in image f/" << fnumber);
+		TRACE_SCOPE("3.1) detection_mic");
 		MICObservations obs = detection_mic(img, cfg_camera.I());
+		TRACE_COUNTER("mic observations per image", obs.size());
 		mic_obs.insert(std::end(mic_obs), std::begin(obs), std::end(obs));
 	
-		GUI(
-			RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).name("main:white_image_f/"+std::to_string(fnumber)), img);
-			for (const auto& o : obs)
-				RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()).name("main:observations(blue)").pen_color(v::blue).pen_width(5), P2D{o[0], o[1]});    
-			Viewer::update();
-		);
+		if (compote::render::enabled())
+		{
+			compote::render::Overlay overlay{"main:white_image_f/"+std::to_string(fnumber), img};
+			overlay.points.reserve(obs.size());
+			for (const auto& o : obs) overlay.points.emplace_back(o[0], o[1]);
+			compote::render::submit(std::move(overlay));
+		}
     }	
 	//3.2) Optimization
 	PRINT_WARN("\t3.2) MIA geometry parameters calibration");
-	calibration_MIA(mia, mic_obs);
+	{
+		compote::trace::Scope scope{"3.2) calibration_MIA"};
+		scope.arg("mic observations", mic_obs.size());
+		
+		compote::Budget budget; budget.seconds = config.budget; budget.plateau = config.plateau;
+		compote::Schedule schedule = compote::Schedule::parse(config.schedule);
+		if (schedule.empty() and (config.budget > 0. or config.plateau > 0.)) schedule = compote::Schedule::anytime();
+		
+		const auto report = compote::calibrate_mia_anytime(
+			mia, mic_obs, cfg_camera.sensor().width(), cfg_camera.sensor().height(), schedule, budget
+		);
+		scope.arg("stages", report.stages.size());
+		PRINT_INFO("MIA calibration stopped (" << compote::to_string(report.reason) << ") after " << report.stages.size() 
+			<< " stages in " << report.seconds << " s, rmse = " << report.cost);
+	}
    
     PRINT_INFO("Optimized MIA geometry parameters = \n" << mia);  
     RENDER_DEBUG_2D(Viewer::context().layer(Viewer::layer()++).pen_color(v::green).pen_width(5).name("main:optimizedgrid(green)"), mia);
 	clear();
 	
+	TRACE_STEP("(wait)");
 	wait();
 ////////////////////////////////////////////////////////////////////////////////
 // 4) Preprocess white images and Set internal parameters
 ////////////////////////////////////////////////////////////////////////////////
+	TRACE_STEP("4) Preprocessing");
 	PRINT_WARN("4) Preprocessing white images and Computing internal parameters");
 	InternalParameters params;
 
@@ -125,6 +162,7 @@ FORCE_GUI(false);
 		
 	if(save())
 	{
+		TRACE_STEP("5) Save");
 		PRINT_WARN("5) Saving camera parameters");
 		PlenopticCamera mfpc;
 		{
@@ -137,10 +175,16 @@ FORCE_GUI(false);
 		}
 		save("camera-"+std::to_string(getpid())+".js", mfpc);
 		v::save(config.path.params, v::make_serializable(&(mfpc.params())));
+		
+		PRINT_WARN("\t5.1) Saving pixel to micro-image map");
+		const compote::MicroImageMap map{mia, std::size_t(cfg_camera.I()), cfg_camera.sensor().width(), cfg_camera.sensor().height()};
+		map.save(compote::MicroImageMap::path_for(config.path.params));
 	}
 	
+	compote::trace::flush();
 	PRINT_INFO("========= EOF =========");
 
+	compote::render::stop();
 	Viewer::wait();
 	Viewer::stop();
 	return 0;
@@ -39,6 +39,31 @@ Config_t parse_args(int argc, char *argv[])
 		("pparams,p",
 			po::value<std::string>()->default_value("internals.js"),
 			"Path to save camera internal parameters configuration file"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
+		)
+		("overlays",
+			po::value<std::string>()->default_value(""),
+			"Directory to write debug overlays (png) when the GUI is disabled, disabled if empty"
+		)
+		("schedule",
+			po::value<std::string>()->default_value(""),
+			"Coarse-to-fine MIA calibration: comma-separated fractions of centers of the first stages (e.g., 0.1,0.3); disabled if empty, "
+			"unless a budget or plateau is given (0.1,0.3)"
+		)
+		("budget",
+			po::value<double>()->default_value(0.),
+			"Wall-clock budget (s) of the MIA calibration: stages predicted to exceed it are not started; 0 for unlimited"
+		)
+		("plateau",
+			po::value<double>()->default_value(0.),
+			"Stop the coarse-to-fine stages when the relative decrease of the cost is below, 0 to disable"
+		)
+		("telemetry",
+			po::value<std::string>()->default_value(""),
+			"Stream convergence telemetry of the optimizations (JSONL) to a file or to a listening unix socket (unix:<path>), disabled if empty"
 		);
 
 	po::variables_map vm;
@@ -81,9 +106,15 @@ Config_t parse_args(int argc, char *argv[])
 	config.use_gui 	 		= vm["gui"].as<bool>();
 	config.verbose			= vm["verbose"].as<bool>();
 	config.level			= vm["level"].as<std::uint16_t>();
+	config.schedule			= vm["schedule"].as<std::string>();
+	config.budget			= vm["budget"].as<double>();
+	config.plateau			= vm["plateau"].as<double>();
 	config.path.images 		= vm["pimages"].as<std::string>();
 	config.path.camera 		= vm["pcamera"].as<std::string>();
 	config.path.params 		= vm["pparams"].as<std::string>();
+	config.path.trace		= vm["trace"].as<std::string>();
+	config.path.telemetry	= vm["telemetry"].as<std::string>();
+	config.path.overlays	= vm["overlays"].as<std::string>();
 	
 	return config; 
 }
@@ -7,11 +7,17 @@ struct Config_t {
 	bool use_gui;
 	bool verbose;
 	std::uint16_t level;
+	double budget; //wall-clock budget (s), 0 for unlimited
+	double plateau; //relative decrease of the cost between stages below which to stop, 0 to disable
+	std::string schedule; //coarse-to-fine fractions of centers
 	
 	struct {
 		std::string images;
 		std::string camera;
 		std::string params;
+		std::string trace;
+		std::string telemetry;
+		std::string overlays;
 	} path;
 };
 
@@ -0,0 +1,238 @@
+//STD
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdlib>
+//EIGEN
+//BOOST
+//OPENCV
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/graphic/gui.h>
+#include <pleno/io/printer.h>
+
+//geometry
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+//config
+#include <pleno/io/cfg/images.h>
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/scene.h>
+
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/snapshot.h>
+#include <compote/pipeline.h>
+#include <compote/residuals.h>
+
+#include "utils.h"
+
+// Exit codes
+enum Status : int { Pass = 0, Fail = 1, Timeout = 2 };
+
+// QC result, filled as stages complete so that a partial result can be written on timeout
+struct Result {
+	using clock = std::chrono::steady_clock;
+	
+	const clock::time_point start = clock::now();
+	std::vector<std::pair<std::string, double>> stages; //name, end time (s)
+	std::vector<std::string> failures;
+	
+	std::vector<int> frames;
+	std::size_t observations = 0;
+	std::size_t poses = 0;
+	compote::ResidualsReport report;
+	bool evaluated = false;
+	
+	double elapsed() const { return std::chrono::duration<double>(clock::now() - start).count(); }
+};
+
+namespace {
+
+std::mutex mtx;
+std::atomic<bool> written{false};
+
+void stage(Result& result, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock{mtx};
+	result.stages.emplace_back(name, result.elapsed());
+	TRACE_STEP(name);
+}
+
+//Write the result only once (main thread or watchdog)
+void write(const Config_t& config, const Result& result, Status status)
+{
+	std::lock_guard<std::mutex> lock{mtx};
+	if (written.exchange(true)) return;
+	
+	std::ostringstream os;
+	os.precision(6);
+	os << "{\n";
+	os << "\t\"status\": \"" << (status == Pass ? "pass" : status == Fail ? "fail" : "timeout") << "\",\n";
+	os << "\t\"elapsed\": " << result.elapsed() << ", \"budget\": " << config.budget << ",\n";
+	os << "\t\"thresholds\": {\"rmse\": " << config.threshold.rmse << ", \"frame_rmse\": " << config.threshold.frame_rmse 
+		<< ", \"rho_rmse\": " << config.threshold.rho_rmse << ", \"observations\": " << config.threshold.observations << "},\n";
+	
+	os << "\t\"stages\": {";
+	for (std::size_t i = 0; i < result.stages.size(); ++i) 
+		os << (i ? ", " : "") << "\"" << result.stages[i].first << "\": " << result.stages[i].second;
+	os << "},\n";
+	
+	os << "\t\"observations\": " << result.observations << ", \"poses\": " << result.poses << ",\n";
+	if (result.evaluated)
+	{
+		os << "\t\"rmse\": " << result.report.all.rmse() << ", \"rho_rmse\": " << result.report.all.rmse_rho() 
+			<< ", \"max\": " << result.report.all.max << ",\n";
+	}
+	
+	os << "\t\"frames\": [";
+	for (std::size_t i = 0; i < result.frames.size(); ++i)
+	{
+		const int f = result.frames[i];
+		const auto it = result.report.frames.find(f);
+		os << (i ? ",\n\t\t" : "\n\t\t") << "{\"frame\": " << f;
+		if (it != result.report.frames.end()) os << ", \"observations\": " << it->second.n << ", \"rmse\": " << it->second.rmse();
+		os << "}";
+	}
+	os << "\n\t],\n";
+	
+	os << "\t\"failures\": [";
+	for (std::size_t i = 0; i < result.failures.size(); ++i) os << (i ? ", " : "") << "\"" << result.failures[i] << "\"";
+	os << "]\n}\n";
+	
+	if (config.path.output == "") std::cout << os.str() << std::flush;
+	else std::ofstream{config.path.output} << os.str();
+	
+	compote::trace::flush();
+}
+
+} //namespace
+
+int main(int argc, char* argv[])
+{
+	Config_t config = parse_args(argc, argv);
+	
+	Viewer::enable(false);
+	
+	Printer::verbose(config.verbose);
+	Printer::level(config.level);
+	
+	if (config.path.trace != "") compote::trace::enable(config.path.trace);
+	
+	Result result;
+	
+	//Watchdog: when the budget is exceeded, the partial result is written and the process exits
+	std::mutex wmtx; std::condition_variable wcv; bool finished = false;
+	std::thread watchdog{[&]() {
+		if (config.budget <= 0.) return;
+		std::unique_lock<std::mutex> lock{wmtx};
+		if (wcv.wait_for(lock, std::chrono::duration<double>(config.budget), [&]() { return finished; })) return;
+		
+		{ std::lock_guard<std::mutex> l{mtx}; result.failures.emplace_back("time budget exceeded"); }
+		write(config, result, Timeout);
+		std::_Exit(Timeout);
+	}};
+	
+	auto finish = [&](Status status) -> int {
+		{ std::lock_guard<std::mutex> lock{wmtx}; finished = true; }
+		wcv.notify_one();
+		watchdog.join();
+		write(config, result, status);
+		return status;
+	};
+////////////////////////////////////////////////////////////////////////////////	
+// 1) Load Camera, Scene and a few checkerboard images
+////////////////////////////////////////////////////////////////////////////////	
+	stage(result, "1) Load");
+	PRINT_WARN("1) Load Camera, Scene and images from configuration files");
+	PlenopticCamera mfpc;
+	compote::snapshot::load(config.path.camera, config.path.params, mfpc);
+	
+	SceneConfig cfg_scene;
+	v::load(config.path.scene, cfg_scene);
+	DEBUG_ASSERT((cfg_scene.checkerboards().size() > 0u), "No checkerboard model provided.");
+	const CheckerBoard scene{cfg_scene.checkerboards()[0]};
+	
+	ImagesConfig cfg_images;
+	v::load(config.path.images, cfg_images);
+	
+	//Only evenly picked frames are loaded
+	{
+		const auto all = cfg_images.checkerboards();
+		const std::size_t n = std::min(config.frames, all.size());
+		
+		cfg_images.checkerboards().clear();
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			const std::size_t idx = (n > 1) ? i * (all.size() - 1) / (n - 1) : 0;
+			cfg_images.checkerboards().emplace_back(all[idx]);
+			if (cfg_images.checkerboards().back().frame() == -1) cfg_images.checkerboards().back().frame() = idx;
+		}
+	}
+	if (cfg_images.checkerboards().size() == 0u)
+	{
+		{ std::lock_guard<std::mutex> lock{mtx}; result.failures.emplace_back("no checkerboard images"); }
+		return finish(Fail);
+	}
+	
+	compote::Images images;
+	compote::load(cfg_images, images, false, true);
+	{
+		std::lock_guard<std::mutex> lock{mtx}; 
+		for (const auto& iwi : images.checkerboards) result.frames.emplace_back(iwi.frame);
+	}
+////////////////////////////////////////////////////////////////////////////////	
+// 2) Detect features with the calibrated MIA
+////////////////////////////////////////////////////////////////////////////////	
+	stage(result, "2) Detection");
+	PRINT_WARN("2) Detect features on " << images.checkerboards.size() << " frames");
+	const BAPObservations features = compote::detect_features(images, mfpc.mia(), mfpc.params());
+	{ std::lock_guard<std::mutex> lock{mtx}; result.observations = features.size(); }
+////////////////////////////////////////////////////////////////////////////////	
+// 3) Estimate the poses of the fixed camera
+////////////////////////////////////////////////////////////////////////////////	
+	stage(result, "3) Extrinsics");
+	PRINT_WARN("3) Estimate poses");
+	CalibrationPoses poses;
+	compote::extrinsics(poses, mfpc, scene, features, compote::pictures(images));
+	{ std::lock_guard<std::mutex> lock{mtx}; result.poses = poses.size(); }
+////////////////////////////////////////////////////////////////////////////////	
+// 4) Evaluate reprojection errors against thresholds
+////////////////////////////////////////////////////////////////////////////////	
+	stage(result, "4) Evaluation");
+	PRINT_WARN("4) Evaluate reprojection errors");
+	const compote::Residuals residuals = compote::bap_residuals(mfpc, scene, poses, features);
+	const compote::ResidualsReport report = compote::aggregate(residuals);
+	
+	Status status = Pass;
+	{
+		std::lock_guard<std::mutex> lock{mtx};
+		result.report = report;
+		result.evaluated = true;
+		
+		auto fail = [&](const std::string& what) { result.failures.emplace_back(what); };
+		
+		if (report.all.rmse() > config.threshold.rmse) fail("rmse above threshold");
+		if (report.all.rmse_rho() > config.threshold.rho_rmse) fail("rho rmse above threshold");
+		for (const int f : result.frames)
+		{
+			const auto it = report.frames.find(f);
+			if (it == report.frames.end()) { fail("frame " + std::to_string(f) + ": no pose"); continue; }
+			if (it->second.n < config.threshold.observations) fail("frame " + std::to_string(f) + ": not enough observations");
+			if (it->second.rmse() > config.threshold.frame_rmse) fail("frame " + std::to_string(f) + ": rmse above threshold");
+		}
+		
+		if (not result.failures.empty()) status = Fail;
+		result.stages.emplace_back("end", result.elapsed());
+	}
+	
+	return finish(status);
+}
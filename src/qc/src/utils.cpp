@@ -0,0 +1,130 @@
+#include "utils.h"
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(false),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ERR),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("pimages,i",
+			po::value<std::string>()->default_value(""),
+			"Path to images configuration file"
+		)
+		("pcamera,c",
+			po::value<std::string>()->default_value(""),
+			"Path to calibrated camera configuration file"
+		)
+		("pparams,p",
+			po::value<std::string>()->default_value(""),
+			"Path to camera internal parameters configuration file"
+		)
+		("pscene,s",
+			po::value<std::string>()->default_value(""),
+			"Path to scene configuration file"
+		)
+		("frames,n",
+			po::value<std::size_t>()->default_value(3),
+			"Number of checkerboard frames to check (evenly picked among the images)"
+		)
+		("budget,b",
+			po::value<double>()->default_value(30.),
+			"Wall-clock budget (s), the check fails when exceeded (0 = unlimited)"
+		)
+		("max-rmse",
+			po::value<double>()->default_value(1.),
+			"Maximum BAP reprojection RMSE over all frames (pixel)"
+		)
+		("max-frame-rmse",
+			po::value<double>()->default_value(1.5),
+			"Maximum BAP reprojection RMSE of each frame (pixel)"
+		)
+		("max-rho-rmse",
+			po::value<double>()->default_value(1.),
+			"Maximum blur radius RMSE over all frames (pixel)"
+		)
+		("min-observations",
+			po::value<std::size_t>()->default_value(100),
+			"Minimum number of BAP observations of each frame"
+		)
+		("output,o",
+			po::value<std::string>()->default_value(""),
+			"Path to save the QC result (json), printed on stdout if empty"
+		)
+		("trace,t",
+			po::value<std::string>()->default_value(""),
+			"Path to save execution trace (chrome://tracing json), disabled if empty"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "Calibration quality check:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	//check if hepl or no arguments then display usage
+	if (vm.count("help") or argc==1)
+	{
+		/* print usage */
+		std::cout << "Calibration quality check:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check mandatory parameters
+	if(	vm["pimages"].as<std::string>() == ""
+		or vm["pcamera"].as<std::string>() == ""
+		or vm["pparams"].as<std::string>() == ""
+		or vm["pscene"].as<std::string>() == ""
+	)
+	{
+		/* print usage */
+		std::cerr << "Please specify at the configuration files. " << std::endl;
+		std::cout << "Calibration quality check:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	Config_t config;
+	
+	config.verbose					= vm["verbose"].as<bool>();
+	config.level					= vm["level"].as<std::uint16_t>();
+	config.frames					= std::max<std::size_t>(1, vm["frames"].as<std::size_t>());
+	config.budget					= vm["budget"].as<double>();
+	config.threshold.rmse			= vm["max-rmse"].as<double>();
+	config.threshold.frame_rmse		= vm["max-frame-rmse"].as<double>();
+	config.threshold.rho_rmse		= vm["max-rho-rmse"].as<double>();
+	config.threshold.observations	= vm["min-observations"].as<std::size_t>();
+	config.path.images 				= vm["pimages"].as<std::string>();
+	config.path.camera 				= vm["pcamera"].as<std::string>();
+	config.path.params 				= vm["pparams"].as<std::string>();
+	config.path.scene 				= vm["pscene"].as<std::string>();
+	config.path.output 				= vm["output"].as<std::string>();
+	config.path.trace				= vm["trace"].as<std::string>();
+	
+	return config; 
+}
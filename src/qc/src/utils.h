@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	std::size_t frames; //number of checkerboard frames checked
+	double budget; //wall-clock budget (s), 0 = unlimited
+	
+	struct {
+		double rmse; //global BAP reprojection rmse (pixel)
+		double frame_rmse; //per-frame BAP reprojection rmse (pixel)
+		double rho_rmse; //global rho rmse (pixel)
+		std::size_t observations; //minimum number of observations per frame
+	} threshold;
+	
+	struct {
+		std::string images;
+		std::string camera;
+		std::string params;
+		std::string scene;
+		std::string output;
+		std::string trace;
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ctime>
+#include <cstdint>
+#include <algorithm>
+//BOOST
+#include <boost/filesystem.hpp>
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/scene.h>
+#include <pleno/io/cfg/observations.h>
+
+//COMPOTE
+#include <compote/pipeline.h>
+
+// Loaded files shared by the jobs run by the service: jobs of a same campaign usually refer to the
+// same camera, scene, observations and images. Entries are keyed by path and invalidated when the
+// file is modified; the least recently used entries are evicted beyond the capacity. Loading is done
+// outside the lock, so that a job does not wait for another one loading a different file.
+template<typename T>
+class Cache {
+	struct Entry {
+		std::time_t modified;
+		std::shared_ptr<const T> value;
+		std::uint64_t used;
+	};
+	
+	std::map<std::string, Entry> entries;
+	std::uint64_t uses = 0;
+	std::size_t capacity;
+	std::mutex mtx;
+	
+	//Last modification of a comma-separated list of files
+	static std::time_t modified(const std::string& paths)
+	{
+		std::time_t t = 0;
+		std::size_t first = 0;
+		while (first <= paths.size())
+		{
+			std::size_t last = paths.find(',', first);
+			if (last == std::string::npos) last = paths.size();
+			const std::string path = paths.substr(first, last - first);
+			first = last + 1;
+			
+			if (not path.empty()) t = std::max(t, boost::filesystem::last_write_time(path));
+		}
+		return t;
+	}
+
+public:
+	explicit Cache(std::size_t n) : capacity{n} {}
+	
+	//Cached value of path, loaded by load(path) -> T if missing or modified
+	template<typename Load>
+	std::shared_ptr<const T> get(const std::string& path, Load&& load)
+	{
+		const std::time_t t = modified(path);
+		{
+			std::lock_guard<std::mutex> lock{mtx};
+			auto it = entries.find(path);
+			if (it != entries.end() and it->second.modified == t)
+			{
+				it->second.used = ++uses;
+				return it->second.value;
+			}
+		}
+		
+		auto value = std::make_shared<const T>(load(path));
+		if (capacity == 0) return value;
+		
+		std::lock_guard<std::mutex> lock{mtx};
+		entries[path] = Entry{t, value, ++uses};
+		while (entries.size() > capacity)
+		{
+			auto lru = std::min_element(entries.begin(), entries.end(),
+				[](const auto& lhs, const auto& rhs) { return lhs.second.used < rhs.second.used; }
+			);
+			entries.erase(lru);
+		}
+		return value;
+	}
+};
+
+struct JobCache {
+	Cache<PlenopticCameraConfig> cameras{16};
+	Cache<InternalParameters> params{16};
+	Cache<SceneConfig> scenes{16};
+	Cache<ObservationsConfig> observations{16};
+	Cache<compote::Images> images; //decoded images are by far the largest entries
+	
+	explicit JobCache(std::size_t n) : images{n} {}
+};
@@ -0,0 +1,223 @@
+#include "job.h"
+
+//STD
+#include <memory>
+#include <stdexcept>
+//BOOST
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/io/printer.h>
+
+//config
+#include <pleno/io/cfg/images.h>
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/scene.h>
+#include <pleno/io/cfg/observations.h>
+#include <pleno/io/cfg/poses.h>
+
+//COMPOTE
+#include <compote/pipeline.h>
+#include <compote/csv.h>
+
+Job_t load_job(const std::string& path)
+{
+	namespace pt = boost::property_tree;
+	
+	pt::ptree tree;
+	pt::read_json(path, tree);
+	
+	//relative paths are given wrt the job file
+	const auto root = boost::filesystem::absolute(path).parent_path();
+	auto resolve = [&tree, &root](const std::string& key) -> std::string {
+		const std::string p = tree.get<std::string>(key, "");
+		if (p == "" or boost::filesystem::path(p).is_absolute()) return p;
+		return (root / p).string();
+	};
+	
+	Job_t job;
+	
+	job.name 			= boost::filesystem::path(path).stem().string();
+	job.path.images 	= resolve("images");
+	job.path.camera 	= resolve("camera");
+	job.path.params 	= resolve("params");
+	job.path.scene 		= resolve("scene");
+	job.path.features 	= resolve("features");
+	job.invdistortion	= tree.get<bool>("invdistortion", false);
+	job.blur			= tree.get<bool>("blur", false);
+	
+	//jobs run in the service process, so that an invalid job must not abort it
+	if ((job.path.images == "" and job.path.features == "") or job.path.camera == "" or job.path.scene == "")
+		throw std::runtime_error("Job is missing configuration files (images or features, camera and scene are required)");
+	
+	return job;
+}
+
+compote::StopReason run_job(const Job_t& job, const std::string& outdir, JobCache& cache, const compote::Budget& budget)
+{
+	auto output = [&outdir](const std::string& name) { return (boost::filesystem::path(outdir) / name).string(); };
+	
+	PRINT_INFO("========= Multifocus plenoptic camera calibration (job: " << job.name << ") =========");
+////////////////////////////////////////////////////////////////////////////////
+// 1) Load Images and Camera information from configuration files
+////////////////////////////////////////////////////////////////////////////////
+	//images are decoded on first use only
+	std::shared_ptr<const compote::Images> images;
+	auto decoded = [&job, &cache, &images]() -> const compote::Images& {
+		if (job.path.images == "") throw std::runtime_error("Job has no images (needed to compute missing params, features or centers, or blur)");
+		if (not images)
+		{
+			PRINT_WARN("1) Load Images from configuration file");
+			images = cache.images.get(job.path.images, [](const std::string& path) {
+				ImagesConfig cfg_images;
+				v::load(path, cfg_images);
+				
+				compote::Images imgs;
+				compote::load(cfg_images, imgs);
+				return imgs;
+			});
+		}
+		return *images;
+	};
+	
+	PRINT_WARN("2) Load Camera information from configuration file");
+	const auto cfg_camera = cache.cameras.get(job.path.camera, [](const std::string& path) {
+		PlenopticCameraConfig cfg;
+		v::load(path, cfg);
+		return cfg;
+	});
+	
+	MIA mia{cfg_camera->mia()};
+    
+////////////////////////////////////////////////////////////////////////////////
+// 3) Pre-calibration step
+////////////////////////////////////////////////////////////////////////////////
+	InternalParameters params;
+	if(job.path.params == "") //no params available
+	{
+		PRINT_WARN("3) Pre-calibration");
+		params = compote::precalibrate(mia, decoded().whites, *cfg_camera);
+		v::save(output("params-preprocessed.js"), v::make_serializable(&params));
+	}
+	else
+	{
+		PRINT_WARN("3) Load internal parameters from configuration file");
+		params = *cache.params.get(job.path.params, [](const std::string& path) {
+			InternalParameters p;
+			v::load(path, v::make_serializable(&p));
+			return p;
+		});
+	}	
+
+////////////////////////////////////////////////////////////////////////////////
+// 4) Features extraction step
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("4) Features extraction");	
+	BAPObservations bap_obs;
+	MICObservations center_obs;	
+	
+	if(job.path.features == "") //no features available
+	{
+		bap_obs = compote::detect_features(decoded(), mia, params);
+	}
+	else // features available, as csv or ObservationsConfig
+	{	
+		const auto cfg_obs = cache.observations.get(job.path.features, [](const std::string& paths) {
+			ObservationsConfig cfg;
+			compote::csv::load(paths, cfg);
+			return cfg;
+		});
+
+		bap_obs = cfg_obs->features();
+		center_obs = cfg_obs->centers();
+	}
+	if (center_obs.size() == 0u) 
+	{
+		const compote::Images& imgs = decoded();
+		if (imgs.whites.size() <= 1u) throw std::runtime_error("No centers available and no white images to compute them");
+		center_obs = compote::detect_centers(imgs.whites[1].img, cfg_camera->I());
+	}
+	if (bap_obs.size() == 0u or center_obs.size() == 0u)
+		throw std::runtime_error("No observations available (missing features or centers)");
+	{
+		ObservationsConfig cfg_obs;
+		cfg_obs.features() = bap_obs;
+		cfg_obs.centers() = center_obs;			
+		v::save(output("observations.bin.gz"), cfg_obs);
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// 5) Starting Calibration of the MFPC
+////////////////////////////////////////////////////////////////////////////////	
+	PRINT_WARN("5) Starting Calibration of the Plenoptic Camera");
+	const auto cfg_scene = cache.scenes.get(job.path.scene, [](const std::string& path) {
+		SceneConfig cfg;
+		v::load(path, cfg);
+		return cfg;
+	});
+	if (cfg_scene->checkerboards().size() == 0u) throw std::runtime_error("No model available while loading scene");
+	
+	CheckerBoard scene{cfg_scene->checkerboards()[0]};
+	
+	PlenopticCamera mfpc = compote::initial_camera(*cfg_camera, mia, params);
+	save(output("initial-intrinsics.js"), mfpc);
+	
+	auto save_calibration = [&output](const PlenopticCamera& camera, const CalibrationPoses& poses) {
+		save(output("intrinsics.js"), camera);
+		v::save(output("params.js"), v::make_serializable(&(camera.params())));
+		
+		CalibrationPosesConfig cfg_poses;
+		cfg_poses.poses().resize(poses.size());
+		
+		int i=0;
+		for(const auto& [p, f] : poses) {
+			cfg_poses.poses()[i].pose() = p;
+			cfg_poses.poses()[i].frame() = f;
+			++i;
+		}
+		v::save(output("extrinsics.js"), cfg_poses);
+	};
+
+	compote::Options options;
+	options.invdistortion = job.invdistortion;
+	options.blur = job.blur;
+	
+	//pictures are only consumed by the blur calibration (the viewer is disabled)
+	const IndexedImages pictures = job.blur ? compote::pictures(decoded()) : IndexedImages{};
+	
+	CalibrationPoses poses;
+	compote::StopReason reason = compote::StopReason::Completed;
+	if (budget.unlimited())
+	{
+		compote::calibrate(poses, mfpc, scene, bap_obs, center_obs, pictures, options);
+	}
+	else //coarse-to-fine stages started only if they fit in the budget, each estimate saved as it completes
+	{
+		const compote::AnytimeReport report = compote::calibrate_anytime(
+			poses, mfpc, scene, bap_obs, center_obs, pictures, compote::Schedule::anytime(), budget,
+			[&save_calibration](const PlenopticCamera& camera, const CalibrationPoses& estimated, const compote::AnytimeReport&) {
+				save_calibration(camera, estimated);
+			}
+		);
+		reason = report.reason;
+		
+		if (budget.expired())
+		{
+			if (job.invdistortion or job.blur) PRINT_WARN("Budget expired, inverse distortions and blur are not calibrated");
+			reason = compote::StopReason::Budget;
+		}
+		else compote::postcalibrate(poses, mfpc, scene, bap_obs, pictures, options);
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// 6) Save Calibration Parameters
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("6) Save Calibration Parameters");
+	save_calibration(mfpc, poses);
+	
+	PRINT_INFO("========= EOF =========");
+	return reason;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+//COMPOTE
+#include <compote/anytime.h>
+
+#include "cache.h"
+
+// A calibration job, i.e., the bundle of configuration files a `calibrate` run would take.
+// Jobs are described in the spool directory by a json file:
+// { 
+//		"images": "images.js", "camera": "camera.js", "params": "params.js", 
+//		"scene": "scene.js", "features": "observations.bin.gz",
+//		"invdistortion": "false", "blur": "false" 
+// }
+struct Job_t {
+	std::string name;
+	
+	struct {
+		std::string images;
+		std::string camera;
+		std::string params;
+		std::string scene;
+		std::string features;
+	} path;
+	
+	bool invdistortion;
+	bool blur;
+};
+
+Job_t load_job(const std::string& path);
+
+// Run the whole calibration pipeline of a job in the calling thread, loading its files through the cache.
+// Results are written in the output directory as soon as they are available (the intrinsics and poses 
+// after each stage when the budget is limited). Images are only decoded if a stage needs them (no params, 
+// features or centers given, or blur). Throw on failure; return Budget if stages were skipped to stay 
+// within the budget, the best-so-far results being saved.
+compote::StopReason run_job(const Job_t& job, const std::string& outdir, JobCache& cache, const compote::Budget& budget);
@@ -0,0 +1,177 @@
+//STD
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <vector>
+#include <new>
+#include <memory>
+#include <sys/resource.h>
+//BOOST
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+//OPENCV
+#include <opencv2/opencv.hpp>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/graphic/gui.h>
+#include <pleno/io/printer.h>
+
+//COMPOTE
+#include <compote/trace.h>
+#include <compote/log.h>
+
+#include "utils.h"
+#include "spool.h"
+#include "cache.h"
+#include "job.h"
+
+namespace fs = boost::filesystem;
+
+static std::atomic<bool> running{true};
+
+static void on_signal(int) { running = false; }
+
+struct JobStatus {
+	std::string state;
+	int code;
+	double walltime;
+};
+
+static void write_status(const std::string& path, const JobStatus& status)
+{
+	boost::property_tree::ptree tree;
+	tree.put("status", status.state);
+	tree.put("code", status.code);
+	tree.put("walltime", status.walltime);
+	
+	boost::property_tree::write_json(path, tree);
+}
+
+//Run a job in the calling worker thread: its lines are captured in its log, and a failure (exception,
+//exhausted memory) only fails the job. The wall-clock limit is the budget of the anytime calibration.
+static JobStatus execute(const Config_t& config, const Spool& spool, JobCache& cache, const std::string& name)
+{
+	using clock = std::chrono::steady_clock;
+	
+	const std::string jobfile = fs::absolute(fs::path(spool.running()) / name).string();
+	const std::string outdir = fs::absolute(spool.output(fs::path(name).stem().string())).string();
+	fs::create_directories(outdir);
+	
+	const auto start = clock::now();
+	JobStatus status{"failed", EXIT_FAILURE, 0.};
+	std::unique_ptr<compote::log::Capture> capture; //errors included
+	try 
+	{
+		capture = std::make_unique<compote::log::Capture>((fs::path(outdir) / "job.log").string());
+		
+		compote::Budget budget; 
+		budget.seconds = double(config.limits.walltime);
+		
+		const compote::StopReason reason = run_job(load_job(jobfile), outdir, cache, budget);
+		status.state = (reason == compote::StopReason::Budget) ? "timeout" : "done";
+		status.code = EXIT_SUCCESS;
+	}
+	catch (const std::bad_alloc&)
+	{
+		PRINT_ERR("Job (" << name << ") failed: out of memory");
+		status.state = "killed";
+	}
+	catch (const std::exception& e)
+	{
+		PRINT_ERR("Job (" << name << ") failed: " << e.what());
+	}
+	capture.reset();
+	status.walltime = std::chrono::duration<double>(clock::now() - start).count();
+	
+	write_status((fs::path(outdir) / "status.js").string(), status);
+	return status;
+}
+
+int main(int argc, char* argv[])
+{
+	Config_t config = parse_args(argc, argv);
+	
+	Viewer::enable(false);
+	
+	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
+	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	
+	compote::log::start(); //needed to capture the log of each job
+	
+	PRINT_INFO("========= Multifocus plenoptic camera calibration service =========");
+	
+	std::signal(SIGINT, on_signal);
+	std::signal(SIGTERM, on_signal);
+	
+	//limits are shared by the jobs running in the service
+	if (config.limits.memory > 0)
+	{
+		const rlim_t memory = rlim_t(config.limits.memory) * 1024 * 1024;
+		rlimit rl{memory, memory}; 
+		if (setrlimit(RLIMIT_AS, &rl) != 0) PRINT_WARN("Can not limit memory to " << config.limits.memory << " MB");
+	}
+	if (config.limits.threads > 0) cv::setNumThreads(int(config.limits.threads));
+
+////////////////////////////////////////////////////////////////////////////////
+// 1) Initialize spool directory
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("1) Initialize spool directory (" << config.path.spool << ")");
+	Spool spool{config.path.spool};
+	spool.recover();
+	
+	if (config.trace) compote::trace::enable((fs::path(config.path.spool) / "trace.json").string());
+
+////////////////////////////////////////////////////////////////////////////////
+// 2) Start workers
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("2) Start " << config.jobs << " workers");
+	JobQueue queue;
+	JobCache cache{config.cache};
+	//jobs claimed and not released yet, counted by the poller when claiming so that it never claims more than the workers can start
+	std::atomic<std::size_t> claimed{0};
+	
+	std::vector<std::thread> workers; workers.reserve(config.jobs);
+	for (std::size_t w = 0; w < config.jobs; ++w)
+	{
+		workers.emplace_back([&config, &spool, &queue, &cache, &claimed]() {
+			std::string name;
+			while (queue.pop(name))
+			{
+				PRINT_INFO("=== Starting job (" << name << ")");
+				const JobStatus status = execute(config, spool, cache, name);
+				spool.release(name, status.state == "done");
+				PRINT_INFO("=== Job (" << name << ") " << status.state << " in " << status.walltime << "s");
+				--claimed;
+			}
+		});
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// 3) Poll spool directory
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("3) Waiting for jobs in " << spool.incoming());
+	while (running)
+	{
+		//only claim what can be started now, leaving other jobs to concurrent services
+		for (const auto& name : spool.pending())
+		{
+			if (claimed >= config.jobs) break;
+			if (spool.claim(name)) { ++claimed; queue.push(name); }
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(config.poll));
+	}
+	
+	PRINT_WARN("4) Stopping service, waiting for running jobs");
+	queue.close();
+	for (auto& w : workers) w.join();
+	
+	compote::trace::flush();
+	
+	PRINT_INFO("========= EOF =========");
+	return 0;
+}
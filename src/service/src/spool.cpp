@@ -0,0 +1,119 @@
+#include "spool.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+// Boost
+#include <boost/filesystem.hpp>
+
+#include <pleno/io/printer.h>
+
+namespace fs = boost::filesystem;
+
+Spool::Spool(const std::string& path) : root{path}
+{
+	fs::create_directories(incoming());
+	fs::create_directories(running());
+	fs::create_directories(done());
+	fs::create_directories(failed());
+	fs::create_directories((fs::path(root) / "output").string());
+}
+
+std::string Spool::incoming() const { return (fs::path(root) / "incoming").string(); }
+std::string Spool::running() const { return (fs::path(root) / "running").string(); }
+std::string Spool::done() const { return (fs::path(root) / "done").string(); }
+std::string Spool::failed() const { return (fs::path(root) / "failed").string(); }
+std::string Spool::output(const std::string& name) const { return (fs::path(root) / "output" / name).string(); }
+
+std::vector<std::string> Spool::pending() const
+{
+	std::vector<std::pair<std::time_t, std::string>> jobs;
+	
+	boost::system::error_code ec;
+	for (const auto& entry : fs::directory_iterator(incoming(), ec))
+	{
+		if (not fs::is_regular_file(entry.status()) or entry.path().extension() != ".js") continue;
+		jobs.emplace_back(fs::last_write_time(entry.path(), ec), entry.path().filename().string());
+	}
+	
+	std::sort(jobs.begin(), jobs.end());
+	
+	std::vector<std::string> names; names.reserve(jobs.size());
+	for (const auto& [_, name] : jobs) names.emplace_back(name);
+	
+	return names;
+}
+
+bool Spool::claim(const std::string& name) const
+{
+	//the lock follows the file when renamed, so that a job is never in running/ without its owner
+	const int fd = ::open((fs::path(incoming()) / name).c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) return false;
+	if (::flock(fd, LOCK_EX | LOCK_NB) != 0) { ::close(fd); return false; }
+	
+	boost::system::error_code ec;
+	fs::rename(fs::path(incoming()) / name, fs::path(running()) / name, ec);
+	if (ec) { ::close(fd); return false; }
+	
+	std::lock_guard<std::mutex> lock{mtx};
+	locks[name] = fd;
+	return true;
+}
+
+void Spool::release(const std::string& name, bool success) const
+{
+	boost::system::error_code ec;
+	fs::rename(fs::path(running()) / name, fs::path(success ? done() : failed()) / name, ec);
+	if (ec) PRINT_ERR("Can not release job (" << name << "): " << ec.message());
+	
+	std::lock_guard<std::mutex> lock{mtx};
+	if (auto it = locks.find(name); it != locks.end()) { ::close(it->second); locks.erase(it); }
+}
+
+void Spool::recover() const
+{
+	boost::system::error_code ec;
+	for (const auto& entry : fs::directory_iterator(running(), ec))
+	{
+		const int fd = ::open(entry.path().c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) continue;
+		
+		//still owned by a running service
+		if (::flock(fd, LOCK_EX | LOCK_NB) != 0) { ::close(fd); continue; }
+		
+		PRINT_WARN("Recovering interrupted job (" << entry.path().filename().string() << ")");
+		fs::rename(entry.path(), fs::path(incoming()) / entry.path().filename(), ec);
+		::close(fd);
+	}
+}
+
+void JobQueue::push(const std::string& name)
+{
+	{
+		std::lock_guard<std::mutex> lock{mtx};
+		jobs.emplace_back(name);
+	}
+	cv.notify_one();
+}
+
+bool JobQueue::pop(std::string& name)
+{
+	std::unique_lock<std::mutex> lock{mtx};
+	cv.wait(lock, [this]() { return closed or not jobs.empty(); });
+	
+	if (jobs.empty()) return false;
+	
+	name = jobs.front(); jobs.pop_front();
+	return true;
+}
+
+void JobQueue::close()
+{
+	{
+		std::lock_guard<std::mutex> lock{mtx};
+		closed = true;
+	}
+	cv.notify_all();
+}
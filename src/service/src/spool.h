@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+// Spool directory layout:
+//	<spool>/incoming/	job files (*.js) dropped by clients; a job is submitted by renaming it in place
+//	<spool>/running/	job files claimed by the service
+//	<spool>/done/		job files of successful jobs
+//	<spool>/failed/		job files of failed jobs
+//	<spool>/output/<job>/	artifacts, log and status of each job, written as they are produced
+// A claimed job is owned by the service holding an exclusive lock (flock) on its job file, released
+// when the job is released or when the service dies: only jobs without owner are recovered.
+struct Spool {
+	std::string root;
+	
+	mutable std::mutex mtx;
+	mutable std::map<std::string, int> locks; //job name -> locked descriptor of its job file
+	
+	explicit Spool(const std::string& path);
+	
+	std::string incoming() const;
+	std::string running() const;
+	std::string done() const;
+	std::string failed() const;
+	std::string output(const std::string& name) const;
+	
+	// List job files waiting in incoming/, oldest first
+	std::vector<std::string> pending() const;
+	// Lock a pending job and atomically move it to running/; return false if another worker claimed it first
+	bool claim(const std::string& name) const;
+	// Move a running job to done/ or failed/ and unlock it
+	void release(const std::string& name, bool success) const;
+	// Move jobs left in running/ by a dead instance (i.e., not locked) back to incoming/
+	void recover() const;
+};
+
+// Blocking FIFO of job names shared by the workers
+class JobQueue {
+	std::deque<std::string> jobs;
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool closed = false;
+	
+public:
+	void push(const std::string& name);
+	// Wait for a job; return false when the queue is closed and empty
+	bool pop(std::string& name);
+	void close();
+};
@@ -0,0 +1,109 @@
+#include "utils.h"
+
+#include <thread>
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(true),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ALL),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("spool,d",
+			po::value<std::string>()->default_value(""),
+			"Path to spool directory"
+		)
+		("jobs,j",
+			po::value<std::size_t>()->default_value(std::max(1u, std::thread::hardware_concurrency() / 4u)),
+			"Number of jobs running concurrently"
+		)
+		("trace,t",
+			po::value<bool>()->default_value(false),
+			"Save an execution trace (chrome://tracing json) of the service in the spool directory"
+		)
+		("cache",
+			po::value<std::size_t>()->default_value(2),
+			"Number of decoded image sets kept in memory for the next jobs"
+		)
+		("poll",
+			po::value<std::size_t>()->default_value(500),
+			"Polling period of the spool directory (in ms)"
+		)
+		("memory",
+			po::value<std::size_t>()->default_value(0),
+			"Maximum memory of the service, shared by its jobs (in MB, 0 = unlimited)"
+		)
+		("walltime",
+			po::value<std::size_t>()->default_value(0),
+			"Wall-clock budget per job (in s, 0 = unlimited): calibration stages are only started if they fit in it"
+		)
+		("threads",
+			po::value<std::size_t>()->default_value(0),
+			"Maximum number of OpenCV threads of the service (0 = default)"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "Multifocus calibration service:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	//check if hepl or no arguments then display usage
+	if (vm.count("help") or argc==1)
+	{
+		/* print usage */
+		std::cout << "Multifocus calibration service:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check mandatory parameters
+	if(vm["spool"].as<std::string>() == "" or vm["jobs"].as<std::size_t>() == 0)
+	{
+		/* print usage */
+		std::cerr << "Please specify the spool directory and a non-null number of jobs. " << std::endl;
+		std::cout << "Multifocus calibration service:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	
+	Config_t config;
+	
+	config.verbose			= vm["verbose"].as<bool>();
+	config.level			= vm["level"].as<std::uint16_t>();
+	config.jobs				= vm["jobs"].as<std::size_t>();
+	config.poll				= vm["poll"].as<std::size_t>();
+	config.trace			= vm["trace"].as<bool>();
+	config.cache			= vm["cache"].as<std::size_t>();
+	config.limits.memory	= vm["memory"].as<std::size_t>();
+	config.limits.walltime	= vm["walltime"].as<std::size_t>();
+	config.limits.threads	= vm["threads"].as<std::size_t>();
+	config.path.spool 		= vm["spool"].as<std::string>();
+	
+	return config; 
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	std::size_t jobs;
+	std::size_t poll;
+	bool trace;
+	std::size_t cache;
+	
+	struct {
+		std::size_t memory;
+		std::size_t walltime;
+		std::size_t threads;
+	} limits;
+	
+	struct {
+		std::string spool;
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);
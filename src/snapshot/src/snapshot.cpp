@@ -0,0 +1,41 @@
+//STD
+#include <iostream>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+//COMPOTE
+#include <compote/snapshot.h>
+
+#include "utils.h"
+
+int main(int argc, char* argv[])
+{
+	PRINT_INFO("========= Calibration snapshot conversion =========");
+	Config_t config = parse_args(argc, argv);
+	
+	Printer::verbose(config.verbose);
+	Printer::level(config.level);
+	
+	if (config.to_json)
+	{
+		PRINT_WARN("Convert snapshot " << config.path.snapshot << " to json");
+		const compote::snapshot::Snapshot snapshot = compote::snapshot::load(config.path.snapshot);
+		
+		PRINT_INFO("\tcamera: " << snapshot.camera.has_value() << ", params: " << snapshot.params.has_value() 
+			<< ", mia: " << snapshot.mia.has_value() << ", poses: " << snapshot.poses.has_value());
+		
+		compote::snapshot::to_json(snapshot, config.path.camera, config.path.params, config.path.mia, config.path.extrinsics);
+	}
+	else
+	{
+		PRINT_WARN("Convert json configurations to snapshot " << config.path.snapshot);
+		const compote::snapshot::Snapshot snapshot = compote::snapshot::from_json(
+			config.path.camera, config.path.params, config.path.mia, config.path.extrinsics
+		);
+		compote::snapshot::save(config.path.snapshot, snapshot);
+	}
+	
+	PRINT_INFO("========= EOF =========");
+	return 0;
+}
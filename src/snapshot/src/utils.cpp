@@ -0,0 +1,96 @@
+#include "utils.h"
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(true),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ALL),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("snapshot,o",
+			po::value<std::string>()->default_value(""),
+			"Path to the snapshot file"
+		)
+		("to-json,x",
+			po::value<bool>()->default_value(false),
+			"Convert the snapshot to json configuration files (default: json to snapshot)"
+		)
+		("pcamera,c",
+			po::value<std::string>()->default_value(""),
+			"Path to camera configuration file"
+		)
+		("pparams,p",
+			po::value<std::string>()->default_value(""),
+			"Path to camera internal parameters configuration file"
+		)
+		("pmia,m",
+			po::value<std::string>()->default_value(""),
+			"Path to camera configuration file holding a stand-alone MIA (e.g., pre-calibration)"
+		)
+		("extrinsics,e",
+			po::value<std::string>()->default_value(""),
+			"Path to extrinsics parameters file"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "Calibration snapshot conversion:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	//check if hepl or no arguments then display usage
+	if (vm.count("help") or argc==1)
+	{
+		/* print usage */
+		std::cout << "Calibration snapshot conversion:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check mandatory parameters
+	if(vm["snapshot"].as<std::string>() == "")
+	{
+		/* print usage */
+		std::cerr << "Please specify the snapshot file. " << std::endl;
+		std::cout << "Calibration snapshot conversion:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	Config_t config;
+	
+	config.verbose			= vm["verbose"].as<bool>();
+	config.level			= vm["level"].as<std::uint16_t>();
+	config.to_json			= vm["to-json"].as<bool>();
+	config.path.snapshot 	= vm["snapshot"].as<std::string>();
+	config.path.camera 		= vm["pcamera"].as<std::string>();
+	config.path.params 		= vm["pparams"].as<std::string>();
+	config.path.mia 		= vm["pmia"].as<std::string>();
+	config.path.extrinsics	= vm["extrinsics"].as<std::string>();
+	
+	return config; 
+}
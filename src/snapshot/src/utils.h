@@ -0,0 +1,21 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	bool to_json; //snapshot -> json, otherwise json -> snapshot
+	
+	struct {
+		std::string snapshot;
+		std::string camera;
+		std::string params;
+		std::string mia;
+		std::string extrinsics;
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);
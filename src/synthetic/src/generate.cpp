@@ -0,0 +1,183 @@
+#include "generate.h"
+
+//STD
+#include <cmath>
+#include <algorithm>
+
+//LIBPLENO
+#include <pleno/io/printer.h>
+
+void resize(PlenopticCameraConfig& cfg, InternalParameters& params, std::size_t width, std::size_t height, std::size_t I)
+{
+	auto cycle = [](std::vector<double>& values, std::size_t n) {
+		if (values.empty() or n == 0) return;
+		const std::vector<double> ref = values;
+		values.resize(n);
+		for (std::size_t i = 0; i < n; ++i) values[i] = ref[i % ref.size()];
+	};
+	
+	if (width > 0 or height > 0)
+	{
+		const std::size_t w0 = cfg.mia().mesh().width();
+		const std::size_t h0 = cfg.mia().mesh().height();
+		const std::size_t w = (width > 0) ? width : w0;
+		const std::size_t h = (height > 0) ? height : h0;
+		
+		//the sensor grows with the array, keeping the same pitch
+		cfg.sensor().width() = std::size_t(std::ceil(double(cfg.sensor().width()) * w / w0));
+		cfg.sensor().height() = std::size_t(std::ceil(double(cfg.sensor().height()) * h / h0));
+		
+		cfg.mia().mesh().width() = w; cfg.mia().mesh().height() = h;
+		cfg.mla().mesh().width() = w; cfg.mla().mesh().height() = h;
+	}
+	
+	if (I > 0)
+	{
+		cfg.I() = I;
+		cycle(cfg.mla().focal_lengths(), I);
+		cycle(cfg.focal_planes(), I);
+		
+		params.I = I;
+		cycle(params.q, I);
+		cycle(params.q_prime, I);
+	}
+}
+
+Pose perturb(const Pose& base, double rotation, double translation, std::mt19937& gen)
+{
+	std::uniform_real_distribution<double> unif(-1., 1.);
+	
+	Eigen::Vector3d axis{unif(gen), unif(gen), unif(gen)};
+	if (axis.norm() < 1e-9) axis = Eigen::Vector3d::UnitZ();
+	axis.normalize();
+	
+	const double angle = unif(gen) * rotation * M_PI / 180.;
+	
+	Pose pose = base;
+	pose.rotation() = Eigen::AngleAxisd(angle, axis).toRotationMatrix() * base.rotation();
+	pose.translation() = base.translation() + translation * Eigen::Vector3d{unif(gen), unif(gen), unif(gen)};
+	
+	return pose;
+}
+
+namespace {
+
+//Project a corner (in camera frame) in micro-image (k,l), return true if it falls inside the micro-image
+bool project_in(const PlenopticCamera& mfpc, const P3D& p, std::size_t k, std::size_t l, double radius, P3D& bap)
+{
+	if (not mfpc.project(p, k, l, bap)) return false;
+	
+	const P2D c = mfpc.mia().nodeInWorld(k, l);
+	return (P2D{bap[0], bap[1]} - c).norm() < radius;
+}
+
+} //namespace
+
+BAPObservations generate_features(
+	const PlenopticCamera& mfpc, CheckerBoard scene, const Pose& pose, int frame,
+	const Config_t& config, std::mt19937& gen
+)
+{
+	std::normal_distribution<double> noise(0., 1.);
+	std::uniform_real_distribution<double> unif(0., 1.);
+	
+	const std::size_t K = mfpc.mia().width();
+	const std::size_t L = mfpc.mia().height();
+	const double radius = mfpc.mia().diameter() / 2. - 1.; //discard the micro-image border
+	
+	//a corner is seen by a compact set of neighbouring micro-lenses:
+	//scan a coarse sub-grid to bound it, then scan the bounding box densely. A corner seen by fewer
+	//micro-lenses than the sub-grid spacing may fall between its nodes: the whole MIA is then scanned
+	constexpr std::size_t stride = 4;
+	
+	BAPObservations obs;
+	std::size_t missed = 0; //corners missed by the sub-grid but seen by the whole MIA
+	scene.pose() = pose;
+	
+	for (std::size_t id = 0; id < scene.nbNodes(); ++id)
+	{
+		const P3D p = to_coordinate_system_of(mfpc.pose(), scene.nodeInWorld(id));
+		
+		std::size_t kmin = K, kmax = 0, lmin = L, lmax = 0;
+		P3D bap;
+		for (std::size_t k = 0; k < K; k += stride)
+		{
+			for (std::size_t l = 0; l < L; l += stride)
+			{
+				if (not project_in(mfpc, p, k, l, radius, bap)) continue;
+				kmin = std::min(kmin, k); kmax = std::max(kmax, k);
+				lmin = std::min(lmin, l); lmax = std::max(lmax, l);
+			}
+		}
+		const bool scan = (kmin > kmax); //not seen by the coarse sub-grid
+		if (scan)
+		{
+			kmin = 0; kmax = K - 1; lmin = 0; lmax = L - 1;
+		}
+		else
+		{
+			kmin = (kmin >= stride) ? kmin - stride : 0; kmax = std::min(K - 1, kmax + stride);
+			lmin = (lmin >= stride) ? lmin - stride : 0; lmax = std::min(L - 1, lmax + stride);
+		}
+		const std::size_t size = obs.size();
+		
+		for (std::size_t k = kmin; k <= kmax; ++k)
+		{
+			for (std::size_t l = lmin; l <= lmax; ++l)
+			{
+				if (not project_in(mfpc, p, k, l, radius, bap)) continue;
+				
+				BAPObservation o;
+				o.k = k; o.l = l;
+				o.cluster = id;
+				o.frame = frame;
+				
+				if (unif(gen) < config.noise.outliers) //random detection in the micro-image
+				{
+					const P2D c = mfpc.mia().nodeInWorld(k, l);
+					const double r = radius * std::sqrt(unif(gen));
+					const double t = 2. * M_PI * unif(gen);
+					o.u = c[0] + r * std::cos(t);
+					o.v = c[1] + r * std::sin(t);
+					o.rho = bap[2] * (0.5 + unif(gen));
+				}
+				else
+				{
+					o.u = bap[0] + config.noise.features * noise(gen);
+					o.v = bap[1] + config.noise.features * noise(gen);
+					o.rho = bap[2] + config.noise.rho * noise(gen);
+				}
+				
+				obs.emplace_back(std::move(o));
+			}
+		}
+		if (scan and obs.size() > size) ++missed;
+	}
+	
+	if (missed > 0) PRINT_DEBUG("Frame " << frame << ": " << missed << " corners missed by the coarse sub-grid, found by a full scan");
+	return obs;
+}
+
+MICObservations generate_centers(const PlenopticCamera& mfpc, const Config_t& config, std::mt19937& gen)
+{
+	std::normal_distribution<double> noise(0., 1.);
+	
+	MICObservations obs; obs.reserve(mfpc.mia().width() * mfpc.mia().height());
+	for (std::size_t k = 0; k < mfpc.mia().width(); ++k)
+	{
+		for (std::size_t l = 0; l < mfpc.mia().height(); ++l)
+		{
+			const P2D c = mfpc.mia().nodeInWorld(k, l);
+			
+			MICObservation o;
+			o.k = k; o.l = l;
+			o.u = c[0] + config.noise.centers * noise(gen);
+			o.v = c[1] + config.noise.centers * noise(gen);
+			o.cluster = mfpc.mia().type(mfpc.I(), k, l);
+			
+			obs.emplace_back(std::move(o));
+		}
+	}
+	
+	return obs;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <random>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+#include <pleno/io/cfg/camera.h>
+
+#include "utils.h"
+
+//Resize the micro-lenses array (and sensor accordingly) and change the number of micro-lens types;
+//focal lengths and blur coefficients of new types are taken cyclically from the existing ones.
+void resize(PlenopticCameraConfig& cfg, InternalParameters& params, std::size_t width, std::size_t height, std::size_t I);
+
+//Random perturbation of a pose, uniform up to the given rotation (deg) and translation (mm)
+Pose perturb(const Pose& base, double rotation, double translation, std::mt19937& gen);
+
+//Project every checkerboard corner in every micro-image seeing it, with noise and outliers
+BAPObservations generate_features(
+	const PlenopticCamera& mfpc, CheckerBoard scene, const Pose& pose, int frame,
+	const Config_t& config, std::mt19937& gen
+);
+
+//Micro-image centers of the whole MIA, with noise
+MICObservations generate_centers(const PlenopticCamera& mfpc, const Config_t& config, std::mt19937& gen);
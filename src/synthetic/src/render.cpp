@@ -0,0 +1,144 @@
+#include "render.h"
+
+//STD
+#include <cmath>
+//OPENCV
+#include <opencv2/opencv.hpp>
+
+namespace {
+
+constexpr double background = 0.5; //intensity outside of the board
+constexpr double vignetting = 0.3; //intensity loss at the micro-image border
+
+double disk(double r, double radius)
+{
+	if (r > radius) return 0.;
+	const double x = r / radius;
+	return 1. - vignetting * x * x;
+}
+
+} //namespace
+
+Image render_white(const PlenopticCamera& mfpc, double N)
+{
+	Image img = Image::zeros(mfpc.sensor().height(), mfpc.sensor().width(), CV_8UC3);
+	
+	const double radius = 0.5 * mfpc.mia().diameter() * std::min(1., mfpc.main_lens().aperture() / N);
+	
+	for (std::size_t k = 0; k < mfpc.mia().width(); ++k)
+	{
+		for (std::size_t l = 0; l < mfpc.mia().height(); ++l)
+		{
+			const P2D c = mfpc.mia().nodeInWorld(k, l);
+			
+			const int umin = std::max(0, int(std::floor(c[0] - radius)));
+			const int umax = std::min(img.cols - 1, int(std::ceil(c[0] + radius)));
+			const int vmin = std::max(0, int(std::floor(c[1] - radius)));
+			const int vmax = std::min(img.rows - 1, int(std::ceil(c[1] + radius)));
+			
+			for (int v = vmin; v <= vmax; ++v)
+			{
+				auto* row = img.ptr<cv::Vec3b>(v);
+				for (int u = umin; u <= umax; ++u)
+				{
+					const double i = 255. * disk(std::hypot(u - c[0], v - c[1]), radius);
+					row[u] = cv::Vec3b::all(cv::saturate_cast<std::uint8_t>(i));
+				}
+			}
+		}
+	}
+	
+	return img;
+}
+
+Image render_checkerboard(const PlenopticCamera& mfpc, const CheckerBoard& scene, const Pose& pose)
+{
+	Image img = Image::zeros(mfpc.sensor().height(), mfpc.sensor().width(), CV_8UC3);
+	
+	CheckerBoard board = scene; board.pose() = pose;
+	
+	//board frame in world (in squares units): origin at the first corner
+	const P3D o = board.nodeInWorld(0);
+	const P3D ex = board.nodeInWorld(1) - o;
+	const double lph = ex.norm();
+	
+	P3D ey = P3D::Zero();
+	for (std::size_t id = 2; id < board.nbNodes() and ey.norm() < 1e-9; ++id)
+	{
+		const P3D d = board.nodeInWorld(id) - o;
+		ey = d - d.dot(ex) / (lph * lph) * ex;
+	}
+	ey = lph * ey.normalized();
+	
+	//board extent (corners +/- one square)
+	double xmin = 0., xmax = 0., ymin = 0., ymax = 0.;
+	for (std::size_t id = 0; id < board.nbNodes(); ++id)
+	{
+		const P3D d = board.nodeInWorld(id) - o;
+		const double x = d.dot(ex) / (lph * lph), y = d.dot(ey) / (lph * lph);
+		xmin = std::min(xmin, x); xmax = std::max(xmax, x);
+		ymin = std::min(ymin, y); ymax = std::max(ymax, y);
+	}
+	xmin -= 1.; ymin -= 1.; xmax += 1.; ymax += 1.;
+	
+	const double cx = 0.5 * (xmin + xmax), cy = 0.5 * (ymin + ymax);
+	
+	auto project = [&](double x, double y, std::size_t k, std::size_t l, P2D& pixel) -> bool {
+		const P3D p = to_coordinate_system_of(mfpc.pose(), P3D{o + x * ex + y * ey});
+		return mfpc.project(p, k, l, pixel);
+	};
+	
+	//local affine map board -> micro-image around (x,y)
+	auto affine = [&](double x, double y, std::size_t k, std::size_t l, P2D& p0, Eigen::Matrix2d& A) -> bool {
+		P2D px, py;
+		if (not project(x, y, k, l, p0) or not project(x + 1., y, k, l, px) or not project(x, y + 1., k, l, py)) return false;
+		A.col(0) = px - p0; A.col(1) = py - p0;
+		return std::fabs(A.determinant()) > 1e-12;
+	};
+	
+	const double radius = 0.5 * mfpc.mia().diameter();
+	
+	for (std::size_t k = 0; k < mfpc.mia().width(); ++k)
+	{
+		for (std::size_t l = 0; l < mfpc.mia().height(); ++l)
+		{
+			const P2D c = mfpc.mia().nodeInWorld(k, l);
+			
+			//board point seen at the micro-image center, refined once
+			P2D p0; Eigen::Matrix2d A;
+			if (not affine(cx, cy, k, l, p0, A)) continue;
+			Eigen::Vector2d b = Eigen::Vector2d{cx, cy} + A.inverse() * (c - p0);
+			if (not affine(b[0], b[1], k, l, p0, A)) continue;
+			b += A.inverse() * (c - p0);
+			if (not affine(b[0], b[1], k, l, p0, A)) continue;
+			
+			const Eigen::Matrix2d Ainv = A.inverse();
+			
+			const int umin = std::max(0, int(std::floor(c[0] - radius)));
+			const int umax = std::min(img.cols - 1, int(std::ceil(c[0] + radius)));
+			const int vmin = std::max(0, int(std::floor(c[1] - radius)));
+			const int vmax = std::min(img.rows - 1, int(std::ceil(c[1] + radius)));
+			
+			for (int v = vmin; v <= vmax; ++v)
+			{
+				auto* row = img.ptr<cv::Vec3b>(v);
+				for (int u = umin; u <= umax; ++u)
+				{
+					const double w = disk(std::hypot(u - c[0], v - c[1]), radius);
+					if (w <= 0.) continue;
+					
+					const Eigen::Vector2d q = b + Ainv * (P2D{double(u), double(v)} - p0);
+					
+					double i = background;
+					if (q[0] >= xmin and q[0] <= xmax and q[1] >= ymin and q[1] <= ymax)
+						i = (std::abs(long(std::floor(q[0])) + long(std::floor(q[1]))) % 2 == 0) ? 0.1 : 0.9;
+					
+					row[u] = cv::Vec3b::all(cv::saturate_cast<std::uint8_t>(255. * w * i));
+				}
+			}
+		}
+	}
+	
+	cv::GaussianBlur(img, img, cv::Size{3, 3}, 0.7);
+	return img;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/geometry/camera/plenoptic.h>
+
+//Render a raw white image taken at f-number N: vignetted micro-image disks, 
+//whose diameter shrinks with the aperture
+Image render_white(const PlenopticCamera& mfpc, double N);
+
+//Render a raw checkerboard image. The board-to-micro-image mapping is approximated by an affine
+//map in each micro-image (estimated from projections of board points through the micro-lens).
+//Defocus blur is not simulated, images are only slightly smoothed for anti-aliasing.
+Image render_checkerboard(const PlenopticCamera& mfpc, const CheckerBoard& scene, const Pose& pose);
@@ -0,0 +1,196 @@
+//STD
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <random>
+//BOOST
+#include <boost/filesystem.hpp>
+//OPENCV
+#include <opencv2/opencv.hpp>
+
+//LIBPLENO
+#include <pleno/types.h>
+
+#include <pleno/graphic/gui.h>
+#include <pleno/io/printer.h>
+
+//geometry
+#include <pleno/geometry/camera/plenoptic.h>
+#include <pleno/geometry/observation.h>
+
+//config
+#include <pleno/io/cfg/images.h>
+#include <pleno/io/cfg/camera.h>
+#include <pleno/io/cfg/scene.h>
+#include <pleno/io/cfg/observations.h>
+#include <pleno/io/cfg/poses.h>
+
+//COMPOTE
+#include <compote/codec.h>
+
+#include "utils.h"
+#include "generate.h"
+#include "render.h"
+
+namespace fs = boost::filesystem;
+
+//Run f(i) for i in [0,n) over a pool of threads
+template<typename F>
+void parallel_for(std::size_t n, std::size_t nthreads, F&& f)
+{
+	std::atomic<std::size_t> next{0};
+	std::vector<std::thread> threads;
+	for (std::size_t t = 0; t < std::min(n, nthreads); ++t)
+	{
+		threads.emplace_back([&next, &n, &f]() {
+			for (std::size_t i = next++; i < n; i = next++) f(i);
+		});
+	}
+	for (auto& t : threads) t.join();
+}
+
+int main(int argc, char* argv[])
+{
+	PRINT_INFO("========= Synthetic multifocus plenoptic dataset generation =========");
+	Config_t config = parse_args(argc, argv);
+	
+	Viewer::enable(false);
+	
+	Printer::verbose(config.verbose); DEBUG_VAR(Printer::verbose());
+	Printer::level(config.level); DEBUG_VAR(Printer::level());
+	
+	const fs::path output{config.path.output};
+	fs::create_directories(output);
+
+////////////////////////////////////////////////////////////////////////////////
+// 1) Load and adapt camera model
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("1) Load camera model");
+	PlenopticCameraConfig cfg_camera;
+	v::load(config.path.camera, cfg_camera);
+	
+	InternalParameters params;
+	v::load(config.path.params, v::make_serializable(&params));
+	
+	resize(cfg_camera, params, config.width, config.height, config.I);
+	
+	//the generated camera is the ground truth of the dataset
+	const std::string gtcamera = (output / "gt-intrinsics.js").string();
+	v::save(gtcamera, cfg_camera);
+	v::save((output / "gt-params.js").string(), v::make_serializable(&params));
+	
+	PlenopticCamera mfpc;
+	load(gtcamera, mfpc);
+	mfpc.params() = params;
+	
+	PRINT_INFO("Camera = " << mfpc << std::endl);
+
+////////////////////////////////////////////////////////////////////////////////
+// 2) Load scene and generate poses
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("2) Generate " << config.frames << " poses");
+	SceneConfig cfg_scene;
+	v::load(config.path.scene, cfg_scene);
+	DEBUG_ASSERT((cfg_scene.checkerboards().size() > 0u), "No checkerboard model provided.");
+	
+	const CheckerBoard scene{cfg_scene.checkerboards()[0]};
+	
+	CalibrationPosesConfig cfg_base;
+	v::load(config.path.extrinsics, cfg_base);
+	DEBUG_ASSERT((cfg_base.poses().size() > 0u), "No base poses provided.");
+	
+	CalibrationPoses poses; poses.reserve(config.frames);
+	for (std::size_t f = 0; f < config.frames; ++f)
+	{
+		std::mt19937 gen(config.seed + f);
+		const Pose& base = cfg_base.poses()[f % cfg_base.poses().size()].pose();
+		
+		poses.emplace_back(CalibrationPose{perturb(base, config.poses.rotation, config.poses.translation, gen), int(f)});
+	}
+
+////////////////////////////////////////////////////////////////////////////////
+// 3) Generate observations
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("3) Generate observations");
+	std::vector<BAPObservations> features(poses.size());
+	
+	//each frame has its own generator so that results do not depend on scheduling
+	parallel_for(poses.size(), config.threads, [&](std::size_t f) {
+		std::mt19937 gen(config.seed + 7919 * (f + 1));
+		features[f] = generate_features(mfpc, scene, poses[f].pose, poses[f].frame, config, gen);
+	});
+	
+	BAPObservations bap_obs;
+	for (auto& obs : features)
+	{
+		bap_obs.insert(std::end(bap_obs), 
+			std::make_move_iterator(std::begin(obs)),
+			std::make_move_iterator(std::end(obs))
+		);
+	}
+	
+	std::mt19937 gen(config.seed);
+	const MICObservations center_obs = generate_centers(mfpc, config, gen);
+	
+	PRINT_INFO("Generated " << bap_obs.size() << " BAP observations and " << center_obs.size() << " centers");
+
+////////////////////////////////////////////////////////////////////////////////
+// 4) Save dataset
+////////////////////////////////////////////////////////////////////////////////
+	PRINT_WARN("4) Save dataset in " << output.string());
+	{
+		ObservationsConfig cfg_obs;
+		cfg_obs.features() = bap_obs;
+		cfg_obs.centers() = center_obs;
+		compote::codec::save(compote::codec::path((output / "observations.bin").string(), compote::codec::select(config.codec)), cfg_obs);
+	}
+	{
+		CalibrationPosesConfig cfg_poses;
+		cfg_poses.poses().resize(poses.size());
+		for (std::size_t i = 0; i < poses.size(); ++i)
+		{
+			cfg_poses.poses()[i].pose() = poses[i].pose;
+			cfg_poses.poses()[i].frame() = poses[i].frame;
+		}
+		v::save((output / "gt-poses.js").string(), cfg_poses);
+	}
+	
+	if (config.render)
+	{
+		PRINT_WARN("5) Render raw images");
+		fs::create_directories(output / "images");
+		
+		ImagesConfig cfg_images;
+		cfg_images.meta().debayered() = true;
+		cfg_images.meta().format() = 8;
+		cfg_images.meta().rgb() = true;
+		
+		const double N = mfpc.main_lens().aperture();
+		for (const double fnumber : {N, N * std::sqrt(2.), 2. * N})
+		{
+			const std::string path = (output / "images" / ("white-n-" + std::to_string(fnumber) + ".png")).string();
+			cv::imwrite(path, render_white(mfpc, fnumber));
+			
+			cfg_images.whites().emplace_back();
+			cfg_images.whites().back().path() = fs::absolute(path).string();
+			cfg_images.whites().back().fnumber() = fnumber;
+		}
+		cfg_images.mask().path() = cfg_images.whites().front().path();
+		cfg_images.mask().fnumber() = N;
+		
+		cfg_images.checkerboards().resize(poses.size());
+		parallel_for(poses.size(), config.threads, [&](std::size_t f) {
+			const std::string path = (output / "images" / ("checkerboard-" + std::to_string(poses[f].frame) + ".png")).string();
+			cv::imwrite(path, render_checkerboard(mfpc, scene, poses[f].pose));
+			
+			cfg_images.checkerboards()[f].path() = fs::absolute(path).string();
+			cfg_images.checkerboards()[f].fnumber() = N;
+			cfg_images.checkerboards()[f].frame() = poses[f].frame;
+		});
+		
+		v::save((output / "images.js").string(), cfg_images);
+	}
+	
+	PRINT_INFO("========= EOF =========");
+	return 0;
+}
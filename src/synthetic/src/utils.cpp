@@ -0,0 +1,168 @@
+#include "utils.h"
+
+#include <thread>
+
+// Boost
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <pleno/io/printer.h>
+
+
+Config_t parse_args(int argc, char *argv[])
+{
+	namespace po = boost::program_options;
+
+	po::options_description desc("Options");
+	
+	desc.add_options()
+		("help,h", "Print help messages")
+		("verbose,v", 
+			po::value<bool>()->default_value(true),
+			"Enable output with extra information"
+		)
+		("level,l", 
+			po::value<std::uint16_t>()->default_value(Printer::Level::ALL),
+			"Select level of output to print (can be combined):\n"
+			"NONE=0, ERR=1, WARN=2, INFO=4, DEBUG=8, ALL=15"
+		)
+		("pcamera,c",
+			po::value<std::string>()->default_value(""),
+			"Path to calibrated camera parameters file (e.g., intrinsics.js)"
+		)
+		("pparams,p",
+			po::value<std::string>()->default_value(""),
+			"Path to camera internal parameters configuration file"
+		)
+		("pscene,s",
+			po::value<std::string>()->default_value(""),
+			"Path to scene configuration file"
+		)
+		("extrinsics,e",
+			po::value<std::string>()->default_value(""),
+			"Path to poses file used as base poses (e.g., poses.js)"
+		)
+		("output,o",
+			po::value<std::string>()->default_value("synthetic"),
+			"Path to output directory"
+		)
+		("frames,n",
+			po::value<std::size_t>()->default_value(16),
+			"Number of frames to generate"
+		)
+		("width",
+			po::value<std::size_t>()->default_value(0),
+			"Number of micro-lenses along x (0 = camera's)"
+		)
+		("height",
+			po::value<std::size_t>()->default_value(0),
+			"Number of micro-lenses along y (0 = camera's)"
+		)
+		("I",
+			po::value<std::size_t>()->default_value(0),
+			"Number of micro-lens types (0 = camera's)"
+		)
+		("noise",
+			po::value<double>()->default_value(0.1),
+			"Gaussian noise on features (pixel)"
+		)
+		("rho-noise",
+			po::value<double>()->default_value(0.1),
+			"Gaussian noise on blur radius (pixel)"
+		)
+		("center-noise",
+			po::value<double>()->default_value(0.05),
+			"Gaussian noise on micro-image centers (pixel)"
+		)
+		("outliers",
+			po::value<double>()->default_value(0.),
+			"Rate of features replaced by random detections, in [0,1]"
+		)
+		("rotation",
+			po::value<double>()->default_value(5.),
+			"Max rotation perturbation of the base poses (deg)"
+		)
+		("translation",
+			po::value<double>()->default_value(10.),
+			"Max translation perturbation of the base poses (mm)"
+		)
+		("seed",
+			po::value<std::size_t>()->default_value(42),
+			"Seed of the random generator"
+		)
+		("threads,j",
+			po::value<std::size_t>()->default_value(std::max(1u, std::thread::hardware_concurrency())),
+			"Number of threads"
+		)
+		("render,r",
+			po::value<bool>()->default_value(false),
+			"Render raw white and checkerboard images"
+		)
+		("codec",
+			po::value<std::string>()->default_value("gzip"),
+			"Compression codec of the saved observations: gzip (.bin.gz), zstd (.bin.zst) or lz4 (.bin.lz4)"
+		);
+
+	po::variables_map vm;
+	try {
+		po::store(po::parse_command_line(argc, argv, desc), vm);
+	}
+	catch (po::error &e) {
+		/* Invalid options */
+		std::cerr << "Error: " << e.what() << std::endl << std::endl;
+		std::cout << "Synthetic dataset generation:" << std::endl
+		  << desc << std::endl;
+		exit(0);
+	}
+	po::notify(vm);
+	
+	//check if hepl or no arguments then display usage
+	if (vm.count("help") or argc==1)
+	{
+		/* print usage */
+		std::cout << "Synthetic dataset generation:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	//check mandatory parameters
+	if(	vm["pcamera"].as<std::string>() == ""
+		or vm["pparams"].as<std::string>() == ""
+		or vm["pscene"].as<std::string>() == ""
+		or vm["extrinsics"].as<std::string>() == ""
+	)
+	{
+		/* print usage */
+		std::cerr << "Please specify at the configuration files. " << std::endl;
+		std::cout << "Synthetic dataset generation:" << std::endl
+				      << desc << std::endl;
+		exit(0);
+	}
+	
+	
+	Config_t config;
+	
+	config.verbose				= vm["verbose"].as<bool>();
+	config.level				= vm["level"].as<std::uint16_t>();
+	config.frames				= vm["frames"].as<std::size_t>();
+	config.width				= vm["width"].as<std::size_t>();
+	config.height				= vm["height"].as<std::size_t>();
+	config.I					= vm["I"].as<std::size_t>();
+	config.noise.features		= vm["noise"].as<double>();
+	config.noise.rho			= vm["rho-noise"].as<double>();
+	config.noise.centers		= vm["center-noise"].as<double>();
+	config.noise.outliers		= std::clamp(vm["outliers"].as<double>(), 0., 1.);
+	config.poses.rotation		= vm["rotation"].as<double>();
+	config.poses.translation	= vm["translation"].as<double>();
+	config.seed					= vm["seed"].as<std::size_t>();
+	config.threads				= std::max<std::size_t>(1, vm["threads"].as<std::size_t>());
+	config.render				= vm["render"].as<bool>();
+	config.codec				= vm["codec"].as<std::string>();
+	config.path.camera 			= vm["pcamera"].as<std::string>();
+	config.path.params 			= vm["pparams"].as<std::string>();
+	config.path.scene 			= vm["pscene"].as<std::string>();
+	config.path.extrinsics		= vm["extrinsics"].as<std::string>();
+	config.path.output 			= vm["output"].as<std::string>();
+	
+	return config; 
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+struct Config_t {
+	bool verbose;
+	std::uint16_t level;
+	
+	std::size_t frames;
+	std::size_t width; //number of micro-lenses (0 = camera's)
+	std::size_t height;
+	std::size_t I; //number of micro-lens types (0 = camera's)
+	
+	struct {
+		double features; //gaussian noise on BAP features (pixel)
+		double rho; //gaussian noise on blur radius (pixel)
+		double centers; //gaussian noise on micro-image centers (pixel)
+		double outliers; //rate of features replaced by random detections
+	} noise;
+	
+	struct {
+		double rotation; //max rotation perturbation (deg)
+		double translation; //max translation perturbation (mm)
+	} poses;
+	
+	std::size_t seed;
+	std::size_t threads;
+	bool render;
+	std::string codec; //of the saved observations
+	
+	struct {
+		std::string camera;
+		std::string params;
+		std::string scene;
+		std::string extrinsics;
+		std::string output;
+	} path;
+};
+
+Config_t parse_args(int argc, char *argv[]);